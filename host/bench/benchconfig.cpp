@@ -0,0 +1,100 @@
+/* benchconfig.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+/**
+ * @brief One LED configuration of the decoder benchmark. The file is compiled once for every configuration
+ * (BENCH_CONFIG, LED type and segment macros): the firmware is placed in its own namespace, so all of them link together.
+ *
+ */
+
+#include <Arduino.h>
+#include <NeoPixelBus.h>
+#include <esp_timer.h>
+#include <atomic>
+#include <chrono>
+#include "benchmark.h"
+
+#if defined(NEOPIXEL_RGBW)
+	#define LED_DRIVER NeoPixelBus<NeoGrbwFeature, NeoEsp32I2s0Sk6812Method>
+	#define LED_DRIVER2 NeoPixelBus<NeoGrbwFeature, NeoEsp32I2s1Sk6812Method>
+#else
+	#define LED_DRIVER NeoPixelBus<NeoGrbFeature, NeoEsp32I2s0Ws2812xMethod>
+	#define LED_DRIVER2 NeoPixelBus<NeoGrbFeature, NeoEsp32I2s1Ws2812xMethod>
+#endif
+
+#define _BENCH_STR(x) #x
+#define BENCH_STR(x) _BENCH_STR(x)
+#define _BENCH_RUNNER(x) run_##x
+#define BENCH_RUNNER(x) _BENCH_RUNNER(x)
+
+namespace BENCH_CONFIG
+{
+	BenchSerial SerialPort;
+
+	#include "main.h"
+
+	static uint64_t measure(const std::vector<uint8_t>& stream, const BenchOptions& options)
+	{
+		SerialPort.load(stream, options.chunk);
+
+		auto start = std::chrono::steady_clock::now();
+		while (!SerialPort.finished() || base.queueCurrent != base.queueEnd)
+		{
+			serialTaskHandler();
+			processData();
+		}
+		auto end = std::chrono::steady_clock::now();
+
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	}
+}
+
+void BENCH_RUNNER(BENCH_CONFIG)(const BenchOptions& options, std::vector<BenchResult>& results)
+{
+	using namespace BENCH_CONFIG;
+
+	for (int version = 1; version <= 2; version++)
+	{
+		std::vector<uint8_t> stream;
+
+		for (int i = 0; i < options.frames; i++)
+		{
+			std::vector<uint8_t> frame = createAwaFrame(options.leds, version == 2, i);
+			stream.insert(stream.end(), frame.begin(), frame.end());
+		}
+
+		// warm up: set up the LED strip and the caches
+		std::vector<uint8_t> warmup(stream.begin(), stream.begin() + stream.size() / options.frames);
+		measure(warmup, options);
+
+		uint32_t goodFrames = statistics.lifetime.goodFrames;
+		uint64_t nanos = measure(stream, options);
+
+		results.push_back({ BENCH_STR(BENCH_CONFIG), version, options.leds, (uint32_t)options.frames,
+							statistics.lifetime.goodFrames - goodFrames, stream.size(), nanos });
+	}
+}
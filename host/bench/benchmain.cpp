@@ -0,0 +1,100 @@
+/* benchmain.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+/**
+ * @brief Decoder throughput benchmark of the native build: AWA v1/v2 frames go through serialTaskHandler()/processData()
+ * into the in-memory LED strip for every LED configuration. The results are printed as JSON.
+ *
+ * Usage: hyperserial_bench [--leds N] [--frames N] [--chunk N]
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "benchmark.h"
+#include "benchconfigs.h"
+
+#define BENCH_DECLARE(name) void run_##name(const BenchOptions& options, std::vector<BenchResult>& results);
+#define BENCH_ENTRY(name) run_##name,
+
+BENCH_CONFIGS(BENCH_DECLARE)
+
+int main(int argc, char** argv)
+{
+	BenchOptions options;
+	std::vector<BenchResult> results;
+	BenchRunner runners[] = { BENCH_CONFIGS(BENCH_ENTRY) };
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--leds") == 0)
+			options.leds = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--frames") == 0)
+			options.frames = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--chunk") == 0)
+			options.chunk = atoi(argv[i + 1]);
+		else
+		{
+			fprintf(stderr, "Unknown option: %s\n", argv[i]);
+			return 2;
+		}
+	}
+
+	if (options.leds < 1 || options.leds > 65535 || options.frames < 1 || options.chunk < 1)
+	{
+		fprintf(stderr, "Invalid options\n");
+		return 2;
+	}
+
+	for (BenchRunner runner : runners)
+		runner(options, results);
+
+	printf("{\n  \"benchmark\": \"decode\",\n  \"leds\": %d,\n  \"frames\": %d,\n  \"chunk\": %d,\n  \"results\": [\n",
+			options.leds, options.frames, options.chunk);
+
+	bool valid = true;
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchResult& result = results[i];
+		double seconds = result.nanos / 1e9;
+
+		printf("    { \"config\": \"%s\", \"protocol\": %d, \"good_frames\": %u, \"bytes\": %llu, \"seconds\": %.6f, "
+				"\"bytes_per_s\": %.0f, \"frames_per_s\": %.1f, \"ns_per_led\": %.2f }%s\n",
+				result.config, result.protocol, result.goodFrames, (unsigned long long)result.bytes, seconds,
+				result.bytes / seconds, result.frames / seconds, (double)result.nanos / ((double)result.frames * result.leds),
+				(i + 1 < results.size()) ? "," : "");
+
+		valid = valid && (result.goodFrames == result.frames);
+	}
+
+	printf("  ]\n}\n");
+
+	// every frame must be decoded, otherwise the numbers are meaningless
+	return (valid) ? 0 : 1;
+}
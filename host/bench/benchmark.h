@@ -0,0 +1,151 @@
+/* benchmark.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "awaencoder.h"
+
+/**
+ * @brief Options of the decoder benchmark
+ *
+ */
+struct BenchOptions
+{
+	// number of LEDs in the frame
+	int leds = 1000;
+	// number of frames per measurement
+	int frames = 2000;
+	// maximum number of bytes delivered by one available()/read() of the serial port
+	int chunk = 128;
+};
+
+/**
+ * @brief Result of the single measurement
+ *
+ */
+struct BenchResult
+{
+	const char* config;
+	int protocol;
+	int leds;
+	uint32_t frames;
+	uint32_t goodFrames;
+	uint64_t bytes;
+	uint64_t nanos;
+};
+
+/**
+ * @brief Create the AWA frame with random colors
+ *
+ * @param leds number of LEDs
+ * @param version2 append the RGBW calibration (protocol v2)
+ * @param seed
+ * @return std::vector<uint8_t>
+ */
+inline std::vector<uint8_t> createAwaFrame(int leds, bool version2, uint32_t seed)
+{
+	const AwaEncoder::Calibration calibration = { 0xff, 0xa0, 0xa0, 0xa0 };
+	std::vector<uint8_t> frame(AwaEncoder::getFrameSize(leds, version2));
+	uint8_t* colors = frame.data() + AwaEncoder::HEADER_SIZE;
+
+	for (int i = 0; i < leds * 3; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		colors[i] = (uint8_t)(seed >> 16);
+	}
+
+	AwaEncoder::encodeFrame(frame.data(), frame.size(), colors, leds, (version2) ? &calibration : nullptr);
+	return frame;
+}
+
+/**
+ * @brief Serial port mockup: replays the stream in chunks like the UART driver
+ *
+ */
+class BenchSerial
+{
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+	size_t sent = 0;
+	int chunk = 128;
+
+	public:
+		void load(const std::vector<uint8_t>& stream, int maxChunk)
+		{
+			data = stream.data();
+			size = stream.size();
+			sent = 0;
+			chunk = maxChunk;
+		}
+
+		int available()
+		{
+			return (int)std::min(size - sent, (size_t)chunk);
+		}
+
+		size_t read(uint8_t* buffer, size_t length)
+		{
+			size_t count = std::min(size - sent, length);
+
+			memcpy(buffer, data + sent, count);
+			sent += count;
+			return count;
+		}
+
+		bool finished()
+		{
+			return sent >= size;
+		}
+
+		int availableForWrite()
+		{
+			return 0;
+		}
+
+		size_t write(const uint8_t*, size_t size)
+		{
+			return size;
+		}
+
+		size_t print(const char*)
+		{
+			return 0;
+		}
+
+		size_t println(const char*)
+		{
+			return 0;
+		}
+};
+
+typedef void (*BenchRunner)(const BenchOptions& options, std::vector<BenchResult>& results);
+
+#endif
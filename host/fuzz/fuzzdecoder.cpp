@@ -0,0 +1,227 @@
+/* fuzzdecoder.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+/**
+ * @brief libFuzzer harness of the AWA decoder. The input is streamed through the ring buffer (serialTaskHandler())
+ * and the decoder (processData()) in chunks of arbitrary size. Checked invariants:
+ * - no LED index outside of the LED strip (FuzzStrip)
+ * - ring buffer positions always inside base.buffer
+ * - bounded work: at most one pixel write per 3 received bytes
+ * - recovery: after 5 seconds without data a valid frame is decoded again
+ *
+ * Input layout: byte 0 = seed of the chunk sizes, the rest = serial data.
+ *
+ */
+
+#include <Arduino.h>
+#include <NeoPixelBus.h>
+#include <esp_timer.h>
+#include <vector>
+#include "awaencoder.h"
+
+#define FUZZ_CHECK(condition) do { if (!(condition)) { fprintf(stderr, "Invariant failed: %s (%s:%d)\n", #condition, __FILE__, __LINE__); abort(); } } while (0)
+
+static uint64_t pixelWrites = 0;
+
+/**
+ * @brief LED strip that validates every pixel index
+ *
+ */
+class FuzzStrip
+{
+	uint16_t count;
+	std::vector<uint8_t> pixels;
+
+	public:
+		FuzzStrip(uint16_t _count, uint8_t = 0) : count(_count), pixels((size_t)_count * 4) {}
+
+		void Begin() {}
+		void Begin(int8_t, int8_t, int8_t, int8_t) {}
+
+		bool CanShow()
+		{
+			return true;
+		}
+
+		void Show(bool = true) {}
+
+		uint16_t PixelCount()
+		{
+			return count;
+		}
+
+		template<typename T> void SetPixelColor(uint16_t index, T&)
+		{
+			FUZZ_CHECK(index < count);
+			pixelWrites++;
+		}
+
+		template<typename T> void ClearTo(T, uint16_t first, uint16_t last)
+		{
+			FUZZ_CHECK(first <= last && last < count);
+		}
+
+		uint8_t* Pixels()
+		{
+			return pixels.data();
+		}
+
+		size_t PixelsSize()
+		{
+			return pixels.size();
+		}
+
+		void Dirty() {}
+};
+
+/**
+ * @brief Serial port mockup: delivers the data in chunks of pseudo-random size
+ *
+ */
+class FuzzSerial
+{
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+	size_t sent = 0;
+	uint32_t seed = 0;
+
+	public:
+		void load(const uint8_t* _data, size_t _size, uint32_t _seed)
+		{
+			data = _data;
+			size = _size;
+			sent = 0;
+			seed = _seed;
+		}
+
+		int available()
+		{
+			seed = seed * 1103515245 + 12345;
+			return (int)std::min(size - sent, (size_t)(1 + ((seed >> 16) % 256)));
+		}
+
+		size_t read(uint8_t* buffer, size_t length)
+		{
+			size_t count = std::min(size - sent, length);
+
+			memcpy(buffer, data + sent, count);
+			sent += count;
+			return count;
+		}
+
+		bool finished()
+		{
+			return sent >= size;
+		}
+
+		int availableForWrite()
+		{
+			return 0;
+		}
+
+		size_t write(const uint8_t*, size_t size)
+		{
+			return size;
+		}
+
+		size_t print(const char*)
+		{
+			return 0;
+		}
+
+		size_t println(const char*)
+		{
+			return 0;
+		}
+} SerialPort;
+
+#define LED_DRIVER FuzzStrip
+#define LED_DRIVER2 FuzzStrip
+#include "main.h"
+
+/**
+ * @brief Stream the data through the ring buffer and the decoder
+ *
+ * @param data
+ * @param size
+ * @param seed
+ */
+static void feed(const uint8_t* data, size_t size, uint32_t seed)
+{
+	SerialPort.load(data, size, seed);
+
+	while (!SerialPort.finished() || base.queueCurrent != base.queueEnd)
+	{
+		serialTaskHandler();
+		FUZZ_CHECK(base.queueEnd >= 0 && base.queueEnd < MAX_BUFFER);
+
+		processData();
+		FUZZ_CHECK(base.queueCurrent >= 0 && base.queueCurrent < MAX_BUFFER);
+		FUZZ_CHECK(base.queueCurrent == base.queueEnd);
+
+		// every chunk takes some time on the wire
+		hostAdvanceClock(100000);
+	}
+}
+
+/**
+ * @brief Create the valid AWA v1 frame with 3 LEDs
+ *
+ * @return std::vector<uint8_t>
+ */
+static std::vector<uint8_t> createValidFrame()
+{
+	const uint8_t colors[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	std::vector<uint8_t> frame(AwaEncoder::getFrameSize(3, false));
+
+	AwaEncoder::encodeFrame(frame.data(), frame.size(), colors, 3);
+	return frame;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	static const std::vector<uint8_t> validFrame = createValidFrame();
+
+	if (size < 1)
+		return 0;
+
+	if (!hostIsVirtualClock())
+		hostUseVirtualClock();
+
+	// the arbitrary input
+	uint64_t writesBefore = pixelWrites;
+	feed(data + 1, size - 1, data[0]);
+	FUZZ_CHECK(pixelWrites - writesBefore <= (size - 1) / 3);
+
+	// 5 seconds of silence, then the decoder must accept the valid frame
+	uint32_t goodFrames = statistics.lifetime.goodFrames;
+	hostAdvanceClock(6000000000ULL);
+	feed(validFrame.data(), validFrame.size(), data[0]);
+	FUZZ_CHECK(statistics.lifetime.goodFrames == goodFrames + 1);
+
+	return 0;
+}
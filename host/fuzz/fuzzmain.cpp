@@ -0,0 +1,190 @@
+/* fuzzmain.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+/**
+ * @brief Standalone driver of the fuzzing harness for compilers without libFuzzer.
+ * Runs the files given in the command line (corpus/crash reproducers) or generates the inputs from valid AWA frames
+ * with random mutations (byte flips, insertions, truncations, control codes).
+ *
+ * Usage: hyperserial_fuzz [--runs N] [--seed N] [file...]
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "awaencoder.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+static uint32_t seed = 1;
+
+static uint32_t nextRandom(uint32_t range)
+{
+	seed = seed * 1103515245 + 12345;
+	return (range > 0) ? ((seed >> 8) % range) : 0;
+}
+
+/**
+ * @brief Append the AWA frame: valid or with the random LED count/version/remap marker/sequence/presentation time
+ *
+ * @param stream
+ */
+static void appendFrame(std::vector<uint8_t>& stream)
+{
+	const uint8_t versions[] = { 'a', 'A', 'm', 's', 'p' };
+	uint16_t count = (nextRandom(4) == 0) ? nextRandom(0x10000) : nextRandom(600);
+	size_t start = stream.size();
+
+	stream.push_back('A');
+	stream.push_back('w');
+	stream.push_back(versions[nextRandom(sizeof(versions))]);
+	stream.push_back(count >> 8);
+	stream.push_back(count & 0xff);
+	stream.push_back((count >> 8) ^ (count & 0xff) ^ 0x55);
+
+	size_t payload = (stream[start + 2] == 'm') ? (count + 1) * 2 : (count + 1) * 3 + ((stream[start + 2] == 'A') ? 4 : 0);
+
+	// the sequence number (and the presentation time)
+	if (stream[start + 2] == 's' || stream[start + 2] == 'p')
+		payload += (stream[start + 2] == 'p') ? 6 : 2;
+	payload = std::min(payload, (size_t)4096);
+
+	for (size_t i = 0; i < payload; i++)
+		stream.push_back((stream[start + 2] == 'm' && (i % 2) == 0) ? nextRandom(3) : nextRandom(256));
+
+	stream.resize(stream.size() + AwaEncoder::TRAILER_SIZE);
+	AwaEncoder::writeChecksum(&stream[start + AwaEncoder::HEADER_SIZE], payload, &stream[start + AwaEncoder::HEADER_SIZE + payload]);
+}
+
+/**
+ * @brief Create the random input for the harness
+ *
+ * @return std::vector<uint8_t>
+ */
+static std::vector<uint8_t> createInput()
+{
+	const uint8_t controls[] = { 0x15, 0x35, 0x45, 0x55, 0x56, 0x65, 0x75, 0x76, 0x85 };
+	std::vector<uint8_t> input;
+
+	input.push_back(nextRandom(256));
+
+	for (int parts = 1 + nextRandom(6); parts > 0; parts--)
+	{
+		switch (nextRandom(4))
+		{
+			case 0:
+				// control frame
+				input.insert(input.end(), { 'A', 'w', 'a', 0x2a, 0xa2, controls[nextRandom(sizeof(controls))] });
+				break;
+			case 1:
+				// random bytes
+				for (int i = nextRandom(300); i > 0; i--)
+					input.push_back(nextRandom(256));
+				break;
+			default:
+				appendFrame(input);
+				break;
+		}
+	}
+
+	// mutations
+	for (int i = nextRandom(8); i > 0 && input.size() > 1; i--)
+	{
+		size_t index = 1 + nextRandom(input.size() - 1);
+
+		switch (nextRandom(3))
+		{
+			case 0:
+				input[index] ^= 1 << nextRandom(8);
+				break;
+			case 1:
+				input.insert(input.begin() + index, nextRandom(256));
+				break;
+			default:
+				input.resize(index);
+				break;
+		}
+	}
+
+	return input;
+}
+
+static int runFile(const char* name)
+{
+	FILE* file = fopen(name, "rb");
+
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Cannot open: %s\n", name);
+		return 1;
+	}
+
+	std::vector<uint8_t> input;
+	uint8_t chunk[4096];
+	size_t size;
+
+	while ((size = fread(chunk, 1, sizeof(chunk), file)) > 0)
+		input.insert(input.end(), chunk, chunk + size);
+	fclose(file);
+
+	printf("Running: %s (%zu bytes)\n", name, input.size());
+	LLVMFuzzerTestOneInput(input.data(), input.size());
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	long runs = 10000;
+	int files = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+			runs = atol(argv[++i]);
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+			seed = (uint32_t)atol(argv[++i]);
+		else if (runFile(argv[i]) == 0)
+			files++;
+		else
+			return 1;
+	}
+
+	if (files > 0)
+		return 0;
+
+	for (long i = 0; i < runs; i++)
+	{
+		std::vector<uint8_t> input = createInput();
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+	}
+
+	printf("Executed %ld inputs, all invariants hold\n", runs);
+	return 0;
+}
@@ -0,0 +1,164 @@
+/* framesink.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef FRAMESINK_H
+#define FRAMESINK_H
+
+/**
+ * @brief Destinations of the frames shown by the native build: null, PPM dump or checksum log.
+ * The pixels come in the order of the LED strips (segment 1, then segment 2) exactly as they are sent to the bus.
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+class FrameSink
+{
+	public:
+		virtual ~FrameSink() {}
+
+		/**
+		 * @brief The frame was shown
+		 *
+		 * @param index frame number
+		 * @param time (us)
+		 * @param pixels
+		 * @param channels bytes per pixel (3: RGB, 4: RGBW)
+		 */
+		virtual void write(uint64_t index, uint64_t time, const std::vector<uint8_t>& pixels, int channels) = 0;
+};
+
+class NullSink : public FrameSink
+{
+	public:
+		void write(uint64_t, uint64_t, const std::vector<uint8_t>&, int) override {}
+};
+
+/**
+ * @brief Every frame as the PPM image (one row, one pixel per LED, the white channel is skipped)
+ *
+ */
+class PpmSink : public FrameSink
+{
+	std::string folder;
+
+	public:
+		PpmSink(const char* _folder) : folder(_folder) {}
+
+		void write(uint64_t index, uint64_t, const std::vector<uint8_t>& pixels, int channels) override
+		{
+			char name[64];
+			size_t count = pixels.size() / channels;
+
+			snprintf(name, sizeof(name), "/frame_%08llu.ppm", (unsigned long long)index);
+			FILE* file = fopen((folder + name).c_str(), "wb");
+			if (file == nullptr)
+				return;
+
+			fprintf(file, "P6\n%zu 1\n255\n", count);
+			for (size_t i = 0; i < count; i++)
+				fwrite(&pixels[i * channels], 1, 3, file);
+			fclose(file);
+		}
+};
+
+/**
+ * @brief Log line for every frame: number, time (us), number of LEDs and CRC32 of the pixels
+ *
+ */
+class ChecksumSink : public FrameSink
+{
+	FILE* file;
+	uint32_t table[256];
+
+	public:
+		ChecksumSink(const char* name)
+		{
+			file = (strcmp(name, "-") == 0) ? stdout : fopen(name, "w");
+
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t value = i;
+				for (int bit = 0; bit < 8; bit++)
+					value = (value & 1) ? (0xedb88320 ^ (value >> 1)) : (value >> 1);
+				table[i] = value;
+			}
+		}
+
+		~ChecksumSink()
+		{
+			if (file != nullptr && file != stdout)
+				fclose(file);
+		}
+
+		bool isOpen()
+		{
+			return file != nullptr;
+		}
+
+		void write(uint64_t index, uint64_t time, const std::vector<uint8_t>& pixels, int channels) override
+		{
+			uint32_t crc = 0xffffffff;
+
+			for (uint8_t value : pixels)
+				crc = table[(crc ^ value) & 0xff] ^ (crc >> 8);
+
+			fprintf(file, "%llu %llu %zu %08x\n", (unsigned long long)index, (unsigned long long)time,
+					pixels.size() / channels, crc ^ 0xffffffff);
+			fflush(file);
+		}
+};
+
+/**
+ * @brief Create the sink: "null", "ppm:<folder>" or "checksum:<file or ->"
+ *
+ * @param spec
+ * @return FrameSink* or nullptr if the spec is invalid
+ */
+inline FrameSink* createFrameSink(const char* spec)
+{
+	if (strcmp(spec, "null") == 0)
+		return new NullSink();
+	else if (strncmp(spec, "ppm:", 4) == 0)
+		return new PpmSink(spec + 4);
+	else if (strncmp(spec, "checksum:", 9) == 0)
+	{
+		ChecksumSink* sink = new ChecksumSink(spec + 9);
+
+		if (sink->isOpen())
+			return sink;
+		delete sink;
+	}
+
+	return nullptr;
+}
+
+#endif
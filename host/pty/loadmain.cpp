@@ -0,0 +1,584 @@
+/* loadmain.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+/**
+ * @brief Load generator: sends AWA frames at the given rate to the serial device (the native endpoint pty
+ * or the real ESP32), requests the statistics periodically and prints the device responses.
+ * With --window the frames carry the sequence number and at most N of them are sent ahead of the last frame
+ * shown by the device, so the rate follows the real throughput of the LED strip (--fps is the upper limit then).
+ * With --delay the frames carry the presentation time: the device clock is synchronized (shortest round trip of the clock
+ * command wins, repeated every second) and every frame is shown the given time after it was sent.
+ * With --ping the ping command goes between the frames every given time (one at a time): the round trip, the time
+ * the command waited in the device and the data buffer occupancy are summarized, --ping-log writes every sample (CSV).
+ * --flow selects the flow control of the serial port: none (default), rts (RTS/CTS) or xonxoff (the firmware built with
+ * FLOW_CONTROL_XONXOFF, its binary records are escaped then).
+ *
+ * Usage: hyperserial_load <device> [--leds N] [--fps N] [--duration <s>] [--stats <s>] [--window N] [--delay <ms>]
+ *                         [--ping <ms>] [--ping-log <file>] [--flow <none|rts|xonxoff>]
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "benchmark.h"
+
+// no acknowledgement for that long: the frames in flight are considered lost
+#define ACK_TIMEOUT_US 200000
+// interval of the clock synchronization
+#define CLOCK_SYNC_US 1000000
+// escape byte of the binary records with the XON/XOFF flow control (RECORD_ESCAPE of the firmware)
+#define RECORD_ESCAPE 0x7D
+
+static uint64_t nowMicros()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static bool writeAll(int fd, const uint8_t* data, size_t size)
+{
+	while (size > 0)
+	{
+		ssize_t count = write(fd, data, size);
+
+		if (count < 0 && errno != EINTR && errno != EAGAIN)
+			return false;
+		if (count < 0)
+		{
+			struct pollfd request = { fd, POLLOUT, 0 };
+			poll(&request, 1, 10);
+			continue;
+		}
+		data += count;
+		size -= count;
+	}
+	return true;
+}
+
+/**
+ * @brief Splits the device output into the text (printed) and the binary records (0xA5 0x5A type size payload xor)
+ *
+ */
+class DeviceOutput
+{
+	uint8_t record[64 + 5];
+	size_t position = 0;
+	bool escaped = false;
+
+	void onRecord()
+	{
+		uint8_t checksum = 0;
+
+		for (int i = 0; i < record[3]; i++)
+			checksum ^= record[4 + i];
+		if (checksum != record[4 + record[3]])
+			return;
+
+		if (record[2] == 'K' && record[3] == 8)
+		{
+			ackReceived = record[4] | (record[5] << 8);
+			ackShown = record[6] | (record[7] << 8);
+			ackFreeSpace = getU32(&record[8]);
+			acks++;
+		}
+		else if (record[2] == 'C' && record[3] == 4)
+		{
+			deviceTime = getU32(&record[4]);
+			deviceTimeReceived = nowMicros();
+			clocks++;
+		}
+		else if (record[2] == 'P' && record[3] == 14)
+		{
+			pingReceiveTime = getU32(&record[4]);
+			pingReplyTime = getU32(&record[8]);
+			pingRingOccupancy = getU32(&record[12]);
+			pingTxQueued = record[16] | (record[17] << 8);
+			pingReceived = nowMicros();
+			pings++;
+		}
+	}
+
+	static inline uint32_t getU32(const uint8_t* data)
+	{
+		return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+	}
+
+	public:
+		// XON/XOFF flow control: the record bytes after 0xA5 0x5A are escaped
+		bool unescape = false;
+		uint64_t acks = 0;
+		uint16_t ackReceived = 0;
+		uint16_t ackShown = 0;
+		uint32_t ackFreeSpace = 0;
+		uint64_t clocks = 0;
+		uint32_t deviceTime = 0;
+		uint64_t deviceTimeReceived = 0;
+		uint64_t pings = 0;
+		uint32_t pingReceiveTime = 0;
+		uint32_t pingReplyTime = 0;
+		uint32_t pingRingOccupancy = 0;
+		uint16_t pingTxQueued = 0;
+		uint64_t pingReceived = 0;
+
+		void feed(const uint8_t* data, size_t size)
+		{
+			for (size_t i = 0; i < size; i++)
+			{
+				uint8_t value = data[i];
+
+				if (unescape && position >= 2)
+				{
+					if (!escaped && value == RECORD_ESCAPE)
+					{
+						escaped = true;
+						continue;
+					}
+					if (escaped)
+					{
+						value ^= 0x20;
+						escaped = false;
+					}
+				}
+
+				if (position == 0 && value != 0xA5)
+					fputc(value, stdout);
+				else if (position == 1 && value != 0x5A)
+				{
+					fputc(0xA5, stdout);
+					position = 0;
+					i--;
+				}
+				else if (position == 3 && value > 64)
+					position = 0;
+				else
+				{
+					record[position++] = value;
+					if (position >= 4 && position == (size_t)record[3] + 5)
+					{
+						onRecord();
+						position = 0;
+					}
+				}
+			}
+			fflush(stdout);
+		}
+
+		/**
+		 * @brief Read everything the device sent, wait up to the given time for the first data
+		 *
+		 * @param fd
+		 * @param timeoutMs
+		 * @return true if anything was read
+		 */
+		bool read(int fd, int timeoutMs)
+		{
+			uint8_t buffer[1024];
+			ssize_t count;
+			bool any = false;
+			struct pollfd request = { fd, POLLIN, 0 };
+
+			if (timeoutMs > 0)
+				poll(&request, 1, timeoutMs);
+
+			while ((count = ::read(fd, buffer, sizeof(buffer))) > 0)
+			{
+				feed(buffer, count);
+				any = true;
+			}
+			return any;
+		}
+};
+
+/**
+ * @brief Device clock estimate: the device time is taken as the middle of the round trip of the clock command,
+ * the sample with the shortest round trip (the least queuing) wins
+ *
+ */
+class DeviceClock
+{
+	uint64_t requestTime = 0;
+	uint64_t handled = 0;
+
+	public:
+		// device micros() - host micros() (32-bit wrap-around)
+		uint32_t offset = 0;
+		uint64_t bestRoundTrip = UINT64_MAX;
+		uint64_t samples = 0;
+
+		void request(int fd)
+		{
+			uint8_t command[AwaEncoder::COMMAND_SIZE];
+
+			AwaEncoder::encodeCommand(command, sizeof(command), 0x65);
+			requestTime = nowMicros();
+			writeAll(fd, command, sizeof(command));
+		}
+
+		/**
+		 * @brief Take the new clock record as the sample
+		 *
+		 * @param output
+		 */
+		void update(const DeviceOutput& output)
+		{
+			if (output.clocks == handled || requestTime == 0)
+				return;
+
+			uint64_t roundTrip = output.deviceTimeReceived - requestTime;
+
+			handled = output.clocks;
+			samples++;
+			// the clocks drift apart, so the newer sample can be a little slower
+			if (roundTrip <= bestRoundTrip + 500)
+			{
+				bestRoundTrip = std::min(bestRoundTrip, roundTrip);
+				offset = output.deviceTime - (uint32_t)(requestTime + roundTrip / 2);
+			}
+			requestTime = 0;
+		}
+
+		inline uint32_t toDevice(uint64_t hostTime)
+		{
+			return (uint32_t)hostTime + offset;
+		}
+};
+
+/**
+ * @brief Round-trip latency probe: one ping command in flight, the answer splits the round trip into the time
+ * the command waited in the device (serial read => decoded) and the rest (the link and the output queue)
+ *
+ */
+class LinkPinger
+{
+	uint64_t requestTime = 0;
+	uint64_t handled = 0;
+	FILE* log = nullptr;
+
+	public:
+		uint64_t samples = 0;
+		uint64_t lost = 0;
+		uint64_t roundTripMin = UINT64_MAX;
+		uint64_t roundTripMax = 0;
+		uint64_t roundTripSum = 0;
+		uint64_t waitMax = 0;
+		uint64_t waitSum = 0;
+		uint32_t ringMax = 0;
+
+		LinkPinger(FILE* _log) : log(_log)
+		{
+			if (log != nullptr)
+				fprintf(log, "time_us,round_trip_us,device_wait_us,link_us,ring_bytes,tx_queued_bytes\n");
+		}
+
+		/**
+		 * @brief Send the ping unless the previous one is still waiting for the answer
+		 *
+		 * @param fd
+		 */
+		void request(int fd)
+		{
+			if (requestTime != 0 && nowMicros() - requestTime < ACK_TIMEOUT_US)
+				return;
+			if (requestTime != 0)
+				lost++;
+
+			uint8_t command[AwaEncoder::COMMAND_SIZE];
+
+			AwaEncoder::encodeCommand(command, sizeof(command), 0x85);
+			requestTime = nowMicros();
+			writeAll(fd, command, sizeof(command));
+		}
+
+		/**
+		 * @brief Take the new ping record as the sample
+		 *
+		 * @param output
+		 * @param start host time of the test start
+		 */
+		void update(const DeviceOutput& output, uint64_t start)
+		{
+			if (output.pings == handled || requestTime == 0)
+				return;
+
+			uint64_t roundTrip = output.pingReceived - requestTime;
+			uint64_t wait = (uint32_t)(output.pingReplyTime - output.pingReceiveTime);
+
+			handled = output.pings;
+			samples++;
+			roundTripMin = std::min(roundTripMin, roundTrip);
+			roundTripMax = std::max(roundTripMax, roundTrip);
+			roundTripSum += roundTrip;
+			waitMax = std::max(waitMax, wait);
+			waitSum += wait;
+			ringMax = std::max(ringMax, output.pingRingOccupancy);
+
+			if (log != nullptr)
+				fprintf(log, "%llu,%llu,%llu,%llu,%u,%u\n", (unsigned long long)(requestTime - start), (unsigned long long)roundTrip,
+						(unsigned long long)wait, (unsigned long long)((roundTrip > wait) ? roundTrip - wait : 0),
+						output.pingRingOccupancy, output.pingTxQueued);
+			requestTime = 0;
+		}
+};
+
+int main(int argc, char** argv)
+{
+	int leds = 300, fps = 60, window = 0, delayMs = 0, pingMs = 0;
+	long duration = 10, statsInterval = 5;
+	const char* pingLog = nullptr;
+	const char* flow = "none";
+
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s <device> [--leds N] [--fps N] [--duration <s>] [--stats <s>] [--window N] [--delay <ms>] "
+				"[--ping <ms>] [--ping-log <file>] [--flow <none|rts|xonxoff>]\n", argv[0]);
+		return 2;
+	}
+
+	for (int i = 2; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--leds") == 0)
+			leds = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--fps") == 0)
+			fps = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--duration") == 0)
+			duration = atol(argv[i + 1]);
+		else if (strcmp(argv[i], "--stats") == 0)
+			statsInterval = atol(argv[i + 1]);
+		else if (strcmp(argv[i], "--window") == 0)
+			window = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--delay") == 0)
+			delayMs = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--ping") == 0)
+			pingMs = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--ping-log") == 0)
+			pingLog = argv[i + 1];
+		else if (strcmp(argv[i], "--flow") == 0)
+			flow = argv[i + 1];
+		else
+		{
+			fprintf(stderr, "Unknown option: %s\n", argv[i]);
+			return 2;
+		}
+	}
+
+	if (leds < 1 || leds > 65535 || fps < 1 || duration < 1 || window < 0 || window > 1000 || delayMs < 0 || delayMs > 1000 || pingMs < 0 ||
+		(strcmp(flow, "none") != 0 && strcmp(flow, "rts") != 0 && strcmp(flow, "xonxoff") != 0))
+	{
+		fprintf(stderr, "Invalid options\n");
+		return 2;
+	}
+
+	int fd = open(argv[1], O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (fd < 0)
+	{
+		fprintf(stderr, "Cannot open %s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+
+	if (isatty(fd))
+	{
+		struct termios options;
+
+		tcgetattr(fd, &options);
+		cfmakeraw(&options);
+		cfsetispeed(&options, B2000000);
+		cfsetospeed(&options, B2000000);
+		if (strcmp(flow, "rts") == 0)
+			options.c_cflag |= CRTSCTS;
+		else if (strcmp(flow, "xonxoff") == 0)
+			options.c_iflag |= IXON;
+		tcsetattr(fd, TCSANOW, &options);
+	}
+
+	std::vector<std::vector<uint8_t>> frames;
+	for (int i = 0; i < 16; i++)
+		frames.push_back(createAwaFrame(leds, false, i));
+
+	std::vector<uint8_t> sequenced(AwaEncoder::getFrameSize(leds, false, true, true));
+	uint8_t statsRequest[AwaEncoder::COMMAND_SIZE];
+	AwaEncoder::encodeCommand(statsRequest, sizeof(statsRequest), 0x15);
+
+	FILE* pingFile = nullptr;
+	if (pingLog != nullptr && (pingFile = fopen(pingLog, "w")) == nullptr)
+	{
+		fprintf(stderr, "Cannot create %s: %s\n", pingLog, strerror(errno));
+		return 1;
+	}
+
+	DeviceOutput output;
+	output.unescape = (strcmp(flow, "xonxoff") == 0);
+	DeviceClock clock;
+	LinkPinger pinger(pingFile);
+
+	// the initial clock synchronization
+	for (int i = 0; i < 8 && delayMs > 0; i++)
+	{
+		clock.request(fd);
+		for (uint64_t waitStart = nowMicros(); output.clocks == clock.samples && nowMicros() - waitStart < ACK_TIMEOUT_US; )
+			output.read(fd, 1);
+		clock.update(output);
+	}
+	if (delayMs > 0 && clock.bestRoundTrip == UINT64_MAX)
+	{
+		fprintf(stderr, "No answer to the clock command\n");
+		return 1;
+	}
+
+	uint64_t start = nowMicros(), lastStats = start, lastSync = start, lastPing = start, bytes = 0, sent = 0, stalls = 0, timeouts = 0;
+	// sequence number of the last shown frame (sent - 1 - acknowledged = frames in flight)
+	uint16_t acknowledged = 0xffff;
+
+	while (nowMicros() - start < (uint64_t)duration * 1000000)
+	{
+		uint64_t due = start + sent * 1000000 / fps;
+		uint64_t now = nowMicros();
+
+		// the answer to the ping is taken as soon as it comes
+		while (pingMs > 0 && now + 1000 < due)
+		{
+			output.read(fd, (due - now) / 1000);
+			pinger.update(output, start);
+			now = nowMicros();
+		}
+
+		if (now < due)
+			usleep(due - now);
+
+		const std::vector<uint8_t>& frame = frames[sent % frames.size()];
+		const uint8_t* data = frame.data();
+		size_t size = frame.size();
+
+		if (window > 0)
+		{
+			// wait for the acknowledgements while the window is full
+			uint64_t waitStart = nowMicros();
+
+			output.read(fd, 0);
+			if (output.acks > 0)
+				acknowledged = output.ackShown;
+
+			if ((uint16_t)(sent - 1 - acknowledged) >= window)
+			{
+				stalls++;
+				while ((uint16_t)(sent - 1 - acknowledged) >= window && nowMicros() - waitStart < ACK_TIMEOUT_US)
+				{
+					output.read(fd, 1);
+					if (output.acks > 0)
+						acknowledged = output.ackShown;
+				}
+
+				if ((uint16_t)(sent - 1 - acknowledged) >= window)
+				{
+					timeouts++;
+					acknowledged = (uint16_t)(sent - 1);
+				}
+			}
+
+		}
+
+		if (delayMs > 0)
+		{
+			size = AwaEncoder::encodeTimedFrame(sequenced.data(), sequenced.size(), frame.data() + AwaEncoder::HEADER_SIZE,
+												leds, (uint16_t)sent, clock.toDevice(nowMicros() + delayMs * 1000));
+			data = sequenced.data();
+		}
+		else if (window > 0)
+		{
+			size = AwaEncoder::encodeSequencedFrame(sequenced.data(), sequenced.size(), frame.data() + AwaEncoder::HEADER_SIZE,
+													leds, (uint16_t)sent);
+			data = sequenced.data();
+		}
+
+		if (!writeAll(fd, data, size))
+		{
+			fprintf(stderr, "Write error: %s\n", strerror(errno));
+			return 1;
+		}
+		bytes += size;
+		sent++;
+
+		if (statsInterval > 0 && nowMicros() - lastStats >= (uint64_t)statsInterval * 1000000)
+		{
+			writeAll(fd, statsRequest, sizeof(statsRequest));
+			lastStats = nowMicros();
+		}
+
+		if (delayMs > 0 && nowMicros() - lastSync >= CLOCK_SYNC_US)
+		{
+			clock.request(fd);
+			lastSync = nowMicros();
+		}
+
+		if (pingMs > 0 && nowMicros() - lastPing >= (uint64_t)pingMs * 1000)
+		{
+			pinger.request(fd);
+			lastPing = nowMicros();
+		}
+
+		output.read(fd, 0);
+		clock.update(output);
+		pinger.update(output, start);
+	}
+
+	double seconds = (nowMicros() - start) / 1e6;
+
+	// final statistics
+	usleep(100000);
+	writeAll(fd, statsRequest, sizeof(statsRequest));
+	usleep(200000);
+	output.read(fd, 0);
+	close(fd);
+	if (pingFile != nullptr)
+		fclose(pingFile);
+
+	fprintf(stderr, "Sent %llu frames (%.1f FPS), %llu bytes (%.0f B/s)\n", (unsigned long long)sent, sent / seconds,
+			(unsigned long long)bytes, bytes / seconds);
+	if (window > 0)
+		fprintf(stderr, "Acknowledgements: %llu, last received: %u, last shown: %u, free space: %u, window stalls: %llu, timeouts: %llu\n",
+				(unsigned long long)output.acks, output.ackReceived, output.ackShown, output.ackFreeSpace,
+				(unsigned long long)stalls, (unsigned long long)timeouts);
+	if (delayMs > 0)
+		fprintf(stderr, "Clock: %llu samples, shortest round trip: %llu us\n", (unsigned long long)clock.samples,
+				(unsigned long long)clock.bestRoundTrip);
+	if (pingMs > 0)
+		fprintf(stderr, "Ping: %llu samples, %llu lost, round trip min/avg/max: %llu/%llu/%llu us, device wait avg/max: %llu/%llu us, "
+				"data buffer max: %u bytes\n", (unsigned long long)pinger.samples, (unsigned long long)pinger.lost,
+				(unsigned long long)((pinger.samples > 0) ? pinger.roundTripMin : 0),
+				(unsigned long long)((pinger.samples > 0) ? pinger.roundTripSum / pinger.samples : 0),
+				(unsigned long long)pinger.roundTripMax, (unsigned long long)((pinger.samples > 0) ? pinger.waitSum / pinger.samples : 0),
+				(unsigned long long)pinger.waitMax, pinger.ringMax);
+	return 0;
+}
@@ -0,0 +1,167 @@
+/* ptymain.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+/**
+ * @brief Native endpoint of the firmware: the unmodified src/main.cpp (both tasks, statistics, hello responses)
+ * receives the AWA stream on a pseudo-terminal, which HyperHDR or the load generator opens as a serial device.
+ * The shown frames go to the frame sink.
+ *
+ * Usage: hyperserial_pty [--link <path>] [--sink null|ppm:<folder>|checksum:<file>] [--duration <s>] [--report <s>]
+ *   --link      symlink to the pty slave (stable device name for HyperHDR)
+ *   --sink      destination of the shown frames (default: null)
+ *   --duration  stop after the given time, 0 = until Ctrl+C (default: 0)
+ *   --report    print the throughput to stderr every given seconds, 0 = never (default: 10)
+ *
+ */
+
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include <mutex>
+#include "../../src/main.cpp"
+#include "framesink.h"
+
+static volatile sig_atomic_t stopEndpoint = 0;
+static FrameSink* frameSink = nullptr;
+static std::vector<uint8_t> framePixels;
+static uint64_t frameIndex = 0;
+
+static void onSignal(int)
+{
+	stopEndpoint = 1;
+}
+
+/**
+ * @brief Collect the segments of the frame, the last segment completes it
+ *
+ */
+static void onShow(const void* strip, const uint8_t* pixels, size_t count, int channels)
+{
+	if (strip == base.getLedStrip1())
+		framePixels.assign(pixels, pixels + count * channels);
+	else
+		framePixels.insert(framePixels.end(), pixels, pixels + count * channels);
+
+	if (base.getLedStrip2() == nullptr || strip == (const void*)base.getLedStrip2())
+		frameSink->write(frameIndex++, micros(), framePixels, channels);
+}
+
+int main(int argc, char** argv)
+{
+	const char* link = nullptr;
+	const char* sinkSpec = "null";
+	long duration = 0, report = 10;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--link") == 0)
+			link = argv[i + 1];
+		else if (strcmp(argv[i], "--sink") == 0)
+			sinkSpec = argv[i + 1];
+		else if (strcmp(argv[i], "--duration") == 0)
+			duration = atol(argv[i + 1]);
+		else if (strcmp(argv[i], "--report") == 0)
+			report = atol(argv[i + 1]);
+		else
+		{
+			fprintf(stderr, "Unknown option: %s\n", argv[i]);
+			return 2;
+		}
+	}
+
+	frameSink = createFrameSink(sinkSpec);
+	if (frameSink == nullptr)
+	{
+		fprintf(stderr, "Invalid frame sink: %s\n", sinkSpec);
+		return 2;
+	}
+
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+	{
+		perror("Cannot create the pty");
+		return 1;
+	}
+
+	// keep the slave open, so the pty survives reconnections of the client
+	const char* slaveName = ptsname(master);
+	int slave = open(slaveName, O_RDWR | O_NOCTTY);
+	struct termios options;
+
+	tcgetattr(slave, &options);
+	cfmakeraw(&options);
+	tcsetattr(slave, TCSANOW, &options);
+
+	if (link != nullptr)
+	{
+		unlink(link);
+		if (symlink(slaveName, link) != 0)
+			perror("Cannot create the link");
+	}
+
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+
+	hostShowHook = onShow;
+	Serial.attach(master, master);
+	setup();
+
+	fprintf(stderr, "AWA receiver ready on %s%s%s\n", slaveName, (link != nullptr) ? " => " : "", (link != nullptr) ? link : "");
+
+	unsigned long start = millis(), lastReport = start;
+	uint32_t lastBytes = 0, lastFrames = 0;
+
+	while (!stopEndpoint && (duration == 0 || millis() - start < (unsigned long)duration * 1000))
+	{
+		loop();
+		usleep(100000);
+
+		unsigned long now = millis();
+		if (report > 0 && now - lastReport >= (unsigned long)report * 1000)
+		{
+			uint32_t bytes = statistics.lifetime.receivedBytes, frames = statistics.lifetime.showFrames;
+			double seconds = (now - lastReport) / 1000.0;
+
+			fprintf(stderr, "received: %.0f B/s, shown: %.1f FPS, good: %u, total: %u, late: %u, checksum errors: %u\n",
+					(bytes - lastBytes) / seconds, (frames - lastFrames) / seconds, statistics.lifetime.goodFrames,
+					statistics.lifetime.totalFrames, statistics.lifetime.lateFrames, errorStatistics.getChecksumErrors());
+			lastReport = now;
+			lastBytes = bytes;
+			lastFrames = frames;
+		}
+	}
+
+	if (link != nullptr)
+		unlink(link);
+
+	fprintf(stderr, "Frames shown: %llu\n", (unsigned long long)frameIndex);
+
+	// the tasks are still running: leave without the static destructors
+	fflush(stdout);
+	_exit(0);
+}
@@ -0,0 +1,160 @@
+/* capture.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+/**
+ * @brief Capture file of the serial stream: timestamped byte chunks exactly as they were read from the port.
+ *
+ * Layout (little endian):
+ *   header: "HSCAPT01" (8 bytes), baud rate of the captured port (uint32, 0 = unknown)
+ *   chunk:  time since the previous chunk in us (uint32), size (uint16), data (size bytes)
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+#define CAPTURE_MAGIC "HSCAPT01"
+
+struct CaptureChunk
+{
+	// time since the start of the capture (us)
+	uint64_t time;
+	std::vector<uint8_t> data;
+};
+
+class CaptureWriter
+{
+	FILE* file = nullptr;
+	uint64_t lastTime = 0;
+
+	void writeLE(uint32_t value, int size)
+	{
+		for (int i = 0; i < size; i++)
+			fputc((value >> (8 * i)) & 0xff, file);
+	}
+
+	public:
+		~CaptureWriter()
+		{
+			close();
+		}
+
+		bool open(const char* name, uint32_t baud)
+		{
+			file = fopen(name, "wb");
+			if (file == nullptr)
+				return false;
+
+			fwrite(CAPTURE_MAGIC, 1, 8, file);
+			writeLE(baud, 4);
+			lastTime = 0;
+			return true;
+		}
+
+		/**
+		 * @brief Append the chunk, the large chunks are split
+		 *
+		 * @param time since the start of the capture (us)
+		 * @param data
+		 * @param size
+		 */
+		void write(uint64_t time, const uint8_t* data, size_t size)
+		{
+			while (size > 0)
+			{
+				size_t part = std::min(size, (size_t)0xffff);
+
+				writeLE((uint32_t)std::min(time - lastTime, (uint64_t)0xffffffff), 4);
+				writeLE((uint32_t)part, 2);
+				fwrite(data, 1, part, file);
+				lastTime = time;
+				data += part;
+				size -= part;
+			}
+		}
+
+		void close()
+		{
+			if (file != nullptr)
+				fclose(file);
+			file = nullptr;
+		}
+};
+
+/**
+ * @brief Load the whole capture
+ *
+ * @param name
+ * @param baud captured baud rate
+ * @param chunks
+ * @return true if the file is a valid capture
+ */
+inline bool loadCapture(const char* name, uint32_t& baud, std::vector<CaptureChunk>& chunks)
+{
+	FILE* file = fopen(name, "rb");
+	uint8_t header[12];
+	bool valid = false;
+
+	if (file == nullptr)
+		return false;
+
+	if (fread(header, 1, sizeof(header), file) == sizeof(header) && memcmp(header, CAPTURE_MAGIC, 8) == 0)
+	{
+		uint64_t time = 0;
+		uint8_t record[6];
+
+		baud = header[8] | (header[9] << 8) | (header[10] << 16) | ((uint32_t)header[11] << 24);
+		valid = true;
+
+		while (fread(record, 1, sizeof(record), file) == sizeof(record))
+		{
+			CaptureChunk chunk;
+			size_t size = record[4] | (record[5] << 8);
+
+			time += record[0] | (record[1] << 8) | (record[2] << 16) | ((uint32_t)record[3] << 24);
+			chunk.time = time;
+			chunk.data.resize(size);
+			if (fread(chunk.data.data(), 1, size, file) != size)
+			{
+				valid = false;
+				break;
+			}
+			chunks.push_back(std::move(chunk));
+		}
+	}
+
+	fclose(file);
+	return valid;
+}
+
+#endif
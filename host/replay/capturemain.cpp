@@ -0,0 +1,201 @@
+/* capturemain.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+/**
+ * @brief Capture tool: records the serial stream with the timing to the capture file.
+ *
+ * Usage:
+ *   hyperserial_capture <output> --port <device> [--baud N]
+ *       record from the serial port, pty or fifo until the end of the stream or Ctrl+C
+ *   hyperserial_capture <output> --synthetic [--baud N] [--leds N] [--frames N] [--fps N] [--chunk N]
+ *       generate the stream of valid AWA frames with the given rate (chunks delivered at the line speed)
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "benchmark.h"
+#include "capture.h"
+
+static volatile sig_atomic_t stopCapture = 0;
+
+static void onSignal(int)
+{
+	stopCapture = 1;
+}
+
+static uint64_t nowMicros()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static speed_t toSpeed(uint32_t baud)
+{
+	switch (baud)
+	{
+		case 115200: return B115200;
+		case 230400: return B230400;
+		case 460800: return B460800;
+		case 921600: return B921600;
+		case 1000000: return B1000000;
+		case 1500000: return B1500000;
+		case 2000000: return B2000000;
+		case 3000000: return B3000000;
+		case 4000000: return B4000000;
+		default: return B0;
+	}
+}
+
+static int capturePort(CaptureWriter& writer, const char* port, uint32_t baud)
+{
+	int fd = open(port, O_RDONLY | O_NOCTTY);
+
+	if (fd < 0)
+	{
+		fprintf(stderr, "Cannot open %s: %s\n", port, strerror(errno));
+		return 1;
+	}
+
+	if (isatty(fd))
+	{
+		struct termios options;
+
+		tcgetattr(fd, &options);
+		cfmakeraw(&options);
+		if (toSpeed(baud) != B0)
+		{
+			cfsetispeed(&options, toSpeed(baud));
+			cfsetospeed(&options, toSpeed(baud));
+		}
+		tcsetattr(fd, TCSANOW, &options);
+	}
+
+	signal(SIGINT, onSignal);
+
+	uint64_t start = nowMicros();
+	uint64_t total = 0;
+	uint8_t buffer[4096];
+
+	while (!stopCapture)
+	{
+		ssize_t size = read(fd, buffer, sizeof(buffer));
+
+		if (size < 0 && errno == EINTR)
+			continue;
+		if (size <= 0)
+			break;
+
+		writer.write(nowMicros() - start, buffer, size);
+		total += size;
+	}
+
+	close(fd);
+	fprintf(stderr, "Captured %llu bytes in %.3f s\n", (unsigned long long)total, (nowMicros() - start) / 1e6);
+	return 0;
+}
+
+static int captureSynthetic(CaptureWriter& writer, uint32_t baud, int leds, int frames, int fps, int chunk)
+{
+	uint64_t lineTime = 0;
+
+	for (int i = 0; i < frames; i++)
+	{
+		std::vector<uint8_t> frame = createAwaFrame(leds, false, i);
+		uint64_t frameTime = (uint64_t)i * 1000000 / fps;
+
+		// the host sends the frame at its time or when the line is free
+		lineTime = std::max(lineTime, frameTime);
+		for (size_t sent = 0; sent < frame.size(); sent += chunk)
+		{
+			size_t size = std::min((size_t)chunk, frame.size() - sent);
+
+			lineTime += (uint64_t)size * 10 * 1000000 / baud;
+			writer.write(lineTime, &frame[sent], size);
+		}
+	}
+
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	const char* port = nullptr;
+	bool synthetic = false;
+	uint32_t baud = 2000000;
+	int leds = 300, frames = 600, fps = 60, chunk = 120;
+
+	if (argc < 3)
+	{
+		fprintf(stderr, "Usage: %s <output> --port <device> [--baud N]\n"
+						"       %s <output> --synthetic [--baud N] [--leds N] [--frames N] [--fps N] [--chunk N]\n", argv[0], argv[0]);
+		return 2;
+	}
+
+	for (int i = 2; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--synthetic") == 0)
+			synthetic = true;
+		else if (i + 1 >= argc)
+			break;
+		else if (strcmp(argv[i], "--port") == 0)
+			port = argv[++i];
+		else if (strcmp(argv[i], "--baud") == 0)
+			baud = atol(argv[++i]);
+		else if (strcmp(argv[i], "--leds") == 0)
+			leds = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--frames") == 0)
+			frames = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--fps") == 0)
+			fps = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--chunk") == 0)
+			chunk = atoi(argv[++i]);
+	}
+
+	if ((port == nullptr) == !synthetic || baud == 0 || leds < 1 || leds > 65535 || fps < 1 || chunk < 1)
+	{
+		fprintf(stderr, "Invalid options\n");
+		return 2;
+	}
+
+	CaptureWriter writer;
+
+	if (!writer.open(argv[1], baud))
+	{
+		fprintf(stderr, "Cannot create %s\n", argv[1]);
+		return 1;
+	}
+
+	return (synthetic) ? captureSynthetic(writer, baud, leds, frames, fps, chunk) : capturePort(writer, port, baud);
+}
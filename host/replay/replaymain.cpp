@@ -0,0 +1,271 @@
+/* replaymain.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+/**
+ * @brief Replay driver: feeds the captured serial stream into serialTaskHandler()/processData() on the virtual clock
+ * (the LED strip model of the shims occupies the bus for the real transfer time),
+ * with the original timing or scaled to another baud rate. Reports the frame, error and latency statistics as JSON.
+ *
+ * Usage: hyperserial_replay <capture> [--baud N] [--fifo N] [--cpu-ns-per-byte N]
+ *   --baud             replay speed: the captured timing is scaled by captured baud / N (default: original timing)
+ *   --fifo             the chunks are split into UART FIFO reads of this size spread over the line time (default: 120)
+ *   --cpu-ns-per-byte  simulated decoding cost of the firmware, the virtual clock advances by it (default: 0)
+ *
+ */
+
+#include <Arduino.h>
+#include <NeoPixelBus.h>
+#include <deque>
+#include "capture.h"
+
+/**
+ * @brief Serial port mockup: the bytes delivered by the UART wait in the driver buffer of the firmware size
+ *
+ */
+class ReplaySerial
+{
+	std::deque<uint8_t> pending;
+
+	public:
+		// size of the driver buffer (the firmware sets it to MAX_BUFFER - 1)
+		size_t capacity = 0;
+		uint64_t droppedBytes = 0;
+
+		/**
+		 * @brief The UART received the data
+		 *
+		 * @param data
+		 * @param size
+		 * @return false if the driver buffer is full and the data was lost
+		 */
+		bool receive(const uint8_t* data, size_t size)
+		{
+			size_t accepted = std::min(size, capacity - std::min(pending.size(), capacity));
+
+			pending.insert(pending.end(), data, data + accepted);
+			droppedBytes += size - accepted;
+			return accepted == size;
+		}
+
+		int available()
+		{
+			return (int)pending.size();
+		}
+
+		size_t read(uint8_t* buffer, size_t length)
+		{
+			size_t count = std::min(pending.size(), length);
+
+			std::copy(pending.begin(), pending.begin() + count, buffer);
+			pending.erase(pending.begin(), pending.begin() + count);
+			return count;
+		}
+
+		int availableForWrite()
+		{
+			return 0;
+		}
+
+		size_t write(const uint8_t*, size_t size)
+		{
+			return size;
+		}
+
+		size_t print(const char*)
+		{
+			return 0;
+		}
+
+		size_t println(const char*)
+		{
+			return 0;
+		}
+} SerialPort;
+
+#if defined(NEOPIXEL_RGBW)
+	#define LED_DRIVER NeoPixelBus<NeoGrbwFeature, NeoEsp32I2s0Sk6812Method>
+	#define LED_DRIVER2 NeoPixelBus<NeoGrbwFeature, NeoEsp32I2s1Sk6812Method>
+#else
+	#define LED_DRIVER NeoPixelBus<NeoGrbFeature, NeoEsp32I2s0Ws2812xMethod>
+	#define LED_DRIVER2 NeoPixelBus<NeoGrbFeature, NeoEsp32I2s1Ws2812xMethod>
+#endif
+#include "main.h"
+
+struct ReplayEvent
+{
+	// arrival of the last byte (ns)
+	uint64_t time;
+	const uint8_t* data;
+	size_t size;
+};
+
+/**
+ * @brief Split the chunks into the UART FIFO reads: a chunk read by the capture at its time was received during the line time before
+ *
+ */
+static std::vector<ReplayEvent> createEvents(const std::vector<CaptureChunk>& chunks, double scale, uint32_t baud, size_t fifo)
+{
+	std::vector<ReplayEvent> events;
+	uint64_t previous = 0;
+
+	for (const CaptureChunk& chunk : chunks)
+	{
+		uint64_t end = (uint64_t)(chunk.time * scale * 1000);
+		uint64_t byteTime = (baud > 0) ? 10000000000ULL / baud : 0;
+		size_t parts = (chunk.data.size() + fifo - 1) / fifo;
+
+		for (size_t i = 0; i < parts; i++)
+		{
+			size_t offset = i * fifo;
+			size_t size = std::min(fifo, chunk.data.size() - offset);
+			uint64_t left = (uint64_t)(chunk.data.size() - offset - size) * byteTime;
+			uint64_t time = std::max(previous, (end > left) ? end - left : 0);
+
+			events.push_back({ time, chunk.data.data() + offset, size });
+			previous = time;
+		}
+	}
+
+	return events;
+}
+
+static void printHistogram(const char* name, LatencyHistogram& histogram, bool last)
+{
+	printf("    \"%s\": { \"p50\": %u, \"p95\": %u, \"p99\": %u, \"samples\": %u }%s\n", name,
+			(unsigned int)histogram.getPercentile(50), (unsigned int)histogram.getPercentile(95),
+			(unsigned int)histogram.getPercentile(99), (unsigned int)histogram.getSamples(), (last) ? "" : ",");
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<CaptureChunk> chunks;
+	uint32_t capturedBaud = 0, targetBaud = 0;
+	size_t fifo = 120;
+	uint64_t cpuNanosPerByte = 0;
+
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s <capture> [--baud N] [--fifo N] [--cpu-ns-per-byte N]\n", argv[0]);
+		return 2;
+	}
+
+	for (int i = 2; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--baud") == 0)
+			targetBaud = atol(argv[i + 1]);
+		else if (strcmp(argv[i], "--fifo") == 0)
+			fifo = atol(argv[i + 1]);
+		else if (strcmp(argv[i], "--cpu-ns-per-byte") == 0)
+			cpuNanosPerByte = atol(argv[i + 1]);
+		else
+		{
+			fprintf(stderr, "Unknown option: %s\n", argv[i]);
+			return 2;
+		}
+	}
+
+	if (!loadCapture(argv[1], capturedBaud, chunks))
+	{
+		fprintf(stderr, "Invalid capture file: %s\n", argv[1]);
+		return 1;
+	}
+
+	if (fifo < 1 || (targetBaud > 0 && capturedBaud == 0))
+	{
+		fprintf(stderr, "Invalid options (scaling needs the baud rate of the capture)\n");
+		return 2;
+	}
+
+	double scale = (targetBaud > 0) ? (double)capturedBaud / targetBaud : 1.0;
+	uint32_t lineBaud = (targetBaud > 0) ? targetBaud : capturedBaud;
+	std::vector<ReplayEvent> events = createEvents(chunks, scale, lineBaud, fifo);
+	uint64_t bytes = 0;
+
+	xSemaphoreHandle wakeup = xSemaphoreCreateBinary();
+
+	hostUseVirtualClock();
+	SerialPort.capacity = MAX_BUFFER - 1;
+	statistics.update(0);
+	renderScheduler.begin(wakeup);
+
+	// the multicore firmware: the serial task polls the port and wakes the processing task on the new data,
+	// the render timer wakes it when the LED bus is free for the late frame. Decoding takes the simulated CPU time.
+	for (size_t next = 0;;)
+	{
+		if (SerialPort.available() == 0 && base.queueCurrent == base.queueEnd)
+		{
+			uint64_t wakeTime = std::min((next < events.size()) ? events[next].time : HOST_CLOCK_NEVER, hostNextTimerDeadline());
+
+			if (wakeTime == HOST_CLOCK_NEVER)
+				break;
+			hostAdvanceClockTo(wakeTime);
+		}
+
+		for (; next < events.size() && events[next].time <= hostClockNanos(); next++)
+		{
+			bytes += events[next].size;
+			if (!SerialPort.receive(events[next].data, events[next].size))
+			{
+				errorStatistics.increase(ErrorType::UART_BUFFER_FULL);
+				base.dataLost = true;
+			}
+		}
+
+		bool wake = serialTaskHandler() || base.queueCurrent != base.queueEnd;
+		if (xSemaphoreTake(wakeup, 0) == pdTRUE)
+			wake = true;
+
+		if (wake)
+		{
+			int queued = (base.queueEnd - base.queueCurrent + MAX_BUFFER) % MAX_BUFFER;
+
+			processData();
+			hostAdvanceClock(queued * cpuNanosPerByte);
+		}
+
+		// polling period of the serial task
+		hostAdvanceClock(1000);
+	}
+
+	printf("{\n  \"capture\": \"%s\",\n  \"captured_baud\": %u,\n  \"replay_baud\": %u,\n  \"bytes\": %llu,\n  \"dropped_bytes\": %llu,\n"
+			"  \"duration_s\": %.6f,\n", argv[1], capturedBaud, lineBaud, (unsigned long long)bytes,
+			(unsigned long long)SerialPort.droppedBytes, hostClockNanos() / 1e9);
+	printf("  \"frames\": { \"total\": %u, \"good\": %u, \"shown\": %u, \"late\": %u, \"blocked_shows\": %u },\n",
+			statistics.lifetime.totalFrames, statistics.lifetime.goodFrames, statistics.lifetime.showFrames, statistics.lifetime.lateFrames,
+			(base.getLedStrip1() != nullptr) ? base.getLedStrip1()->getBlockedShowCount() : 0);
+	printf("  \"ring_high_water\": %u,\n  \"errors\": {\n", (unsigned int)statistics.lifetime.ringHighWater);
+	for (int i = 0; i < (int)ErrorType::COUNT; i++)
+		printf("    \"%s\": %u%s\n", errorStatistics.getName((ErrorType)i), (unsigned int)errorStatistics.getTotal((ErrorType)i),
+				(i + 1 < (int)ErrorType::COUNT) ? "," : "");
+	printf("  },\n  \"latency_us\": {\n");
+	printHistogram("decode", latency.decode, false);
+	printHistogram("queue", latency.queue, false);
+	printHistogram("total", latency.total, true);
+	printf("  }\n}\n");
+
+	return 0;
+}
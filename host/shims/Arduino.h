@@ -0,0 +1,234 @@
+/* Arduino.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/**
+ * @brief Minimal Arduino core for the native (Linux) build: time, random, GPIO levels, ESP object and serial port
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "hostclock.h"
+
+#define ESP_ARDUINO_VERSION_MAJOR 2
+#define ESP_ARDUINO_VERSION_MINOR 0
+#define ESP_ARDUINO_VERSION_PATCH 6
+#define ARDUINO_USB_CDC_ON_BOOT 0
+
+#define DEC 10
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+typedef std::string String;
+
+
+inline unsigned long millis()
+{
+	return (unsigned long)(hostClockNanos() / 1000000);
+}
+
+inline unsigned long micros()
+{
+	return (unsigned long)(hostClockNanos() / 1000);
+}
+
+// the virtual clock moves by the delay, on the wall clock it returns at once
+inline void delay(unsigned long ms)
+{
+	if (hostIsVirtualClock())
+		hostAdvanceClock(ms * 1000000ULL);
+}
+
+inline void delayMicroseconds(unsigned int)
+{
+}
+
+inline void yield()
+{
+}
+
+inline long random(long howbig)
+{
+	return (howbig > 0) ? (::rand() % howbig) : 0;
+}
+
+inline long random(long howsmall, long howbig)
+{
+	return (howbig > howsmall) ? howsmall + random(howbig - howsmall) : howsmall;
+}
+
+inline void randomSeed(unsigned long seed)
+{
+	::srand((unsigned int)seed);
+}
+
+inline int analogRead(int)
+{
+	return 0;
+}
+
+// GPIO levels of the native build, the tests read the outputs back with digitalRead()
+void hostSetPinLevel(int pin, int value);
+int hostGetPinLevel(int pin);
+
+inline void pinMode(int, int)
+{
+}
+
+inline void digitalWrite(int pin, int value)
+{
+	hostSetPinLevel(pin, value);
+}
+
+inline int digitalRead(int pin)
+{
+	return hostGetPinLevel(pin);
+}
+
+// the module has PSRAM (the native build has none unless the test sets it)
+extern bool hostPsramFound;
+
+inline bool psramFound()
+{
+	return hostPsramFound;
+}
+
+inline uint32_t getCpuFrequencyMhz()
+{
+	return 240;
+}
+
+class EspClass
+{
+	public:
+		uint32_t getFreeHeap()
+		{
+			return 0;
+		}
+
+		uint32_t getFreePsram()
+		{
+			return 0;
+		}
+
+		// simulated 240MHz cycle counter
+		uint32_t getCycleCount()
+		{
+			return (uint32_t)(hostClockNanos() * 240 / 1000);
+		}
+};
+
+extern EspClass ESP;
+
+enum hardwareSerial_error_t
+{
+	UART_NO_ERROR,
+	UART_BREAK_ERROR,
+	UART_BUFFER_FULL_ERROR,
+	UART_FIFO_OVF_ERROR,
+	UART_FRAME_ERROR,
+	UART_PARITY_ERROR
+};
+
+/**
+ * @brief Serial port of the native build. Detached: no input, the output goes to stdout.
+ * Attached to the file descriptors (pty, socket): non-blocking reads and writes like the UART driver.
+ *
+ */
+class HardwareSerial
+{
+	int inputFd = -1;
+	int outputFd = 1;
+
+	public:
+		/**
+		 * @brief Connect the port to the file descriptors
+		 *
+		 * @param input
+		 * @param output
+		 */
+		void attach(int input, int output);
+
+		void setRxBufferSize(size_t) {}
+		void setTimeout(unsigned long) {}
+		void begin(unsigned long) {}
+		void onReceiveError(void (*)(hardwareSerial_error_t)) {}
+
+		explicit operator bool() const
+		{
+			return true;
+		}
+
+		// number of bytes waiting, when there is none it waits up to 1ms for them (like the UART interrupt)
+		int available();
+		int read();
+		size_t read(uint8_t* buffer, size_t size);
+		int availableForWrite();
+		size_t write(const uint8_t* data, size_t size);
+
+		size_t write(uint8_t data)
+		{
+			return write(&data, 1);
+		}
+
+		size_t print(const char* text)
+		{
+			return write((const uint8_t*)text, strlen(text));
+		}
+
+		size_t println(const char* text)
+		{
+			return print(text) + print("\r\n");
+		}
+
+		void flush() {}
+};
+
+#if !defined(NO_GLOBAL_SERIAL)
+	extern HardwareSerial Serial;
+#endif
+
+#endif
@@ -0,0 +1,212 @@
+/* NeoPixelBus.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef HOST_NEOPIXELBUS_H
+#define HOST_NEOPIXELBUS_H
+
+/**
+ * @brief NeoPixelBus color types and the LED strip model for the native build
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "hostclock.h"
+
+struct RgbColor
+{
+	uint8_t R = 0, G = 0, B = 0;
+
+	RgbColor() {}
+	RgbColor(uint8_t r, uint8_t g, uint8_t b) : R(r), G(g), B(b) {}
+
+	bool operator==(const RgbColor& other) const
+	{
+		return R == other.R && G == other.G && B == other.B;
+	}
+};
+
+struct RgbwColor
+{
+	uint8_t R = 0, G = 0, B = 0, W = 0;
+
+	RgbwColor() {}
+	RgbwColor(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0) : R(r), G(g), B(b), W(w) {}
+
+	bool operator==(const RgbwColor& other) const
+	{
+		return R == other.R && G == other.G && B == other.B && W == other.W;
+	}
+};
+
+/**
+ * @brief Called by every Show() of the LED strip model with its pixels (channels = bytes per pixel)
+ *
+ */
+extern void (*hostShowHook)(const void* strip, const uint8_t* pixels, size_t count, int channels);
+
+// color features: the color type and the number of bits sent for every LED
+struct NeoGrbFeature { typedef RgbColor ColorObject; enum { BitsPerPixel = 24 }; };
+struct NeoGrbwFeature { typedef RgbwColor ColorObject; enum { BitsPerPixel = 32 }; };
+struct NeoRbgFeature { typedef RgbColor ColorObject; enum { BitsPerPixel = 24 }; };
+struct DotStarBgrFeature { typedef RgbColor ColorObject; enum { BitsPerPixel = 32 }; };
+struct DotStarLbgrFeature { typedef RgbColor ColorObject; enum { BitsPerPixel = 32 }; };
+
+// bus timing of the LED protocols: bit time, reset/latch time, start and end frame bits per LED
+struct Ws2812xTiming { enum { BitNanos = 1250, ResetNanos = 300000, StartBits = 0, EndBitsPer16Leds = 0 }; };
+struct Sk6812Timing { enum { BitNanos = 1250, ResetNanos = 80000, StartBits = 0, EndBitsPer16Leds = 0 }; };
+struct DotStar10MhzTiming { enum { BitNanos = 100, ResetNanos = 0, StartBits = 32, EndBitsPer16Leds = 8 }; };
+struct Ws2801Spi2MhzTiming { enum { BitNanos = 500, ResetNanos = 500000, StartBits = 0, EndBitsPer16Leds = 0 }; };
+
+struct NeoEsp32I2s0Ws2812xMethod : Ws2812xTiming {};
+struct NeoEsp32I2s1Ws2812xMethod : Ws2812xTiming {};
+struct NeoEsp32Rmt0Ws2812xMethod : Ws2812xTiming {};
+struct NeoEsp32Rmt1Ws2812xMethod : Ws2812xTiming {};
+struct NeoEsp32I2s0X8Ws2812Method : Ws2812xTiming {};
+struct NeoEsp32I2s1X8Ws2812Method : Ws2812xTiming {};
+struct NeoEsp32I2s0Sk6812Method : Sk6812Timing {};
+struct NeoEsp32I2s1Sk6812Method : Sk6812Timing {};
+struct NeoEsp32Rmt0Sk6812Method : Sk6812Timing {};
+struct NeoEsp32Rmt1Sk6812Method : Sk6812Timing {};
+struct NeoEsp32I2s0X8Sk6812Method : Sk6812Timing {};
+struct NeoEsp32I2s1X8Sk6812Method : Sk6812Timing {};
+struct DotStarEsp32DmaHspiMethod : DotStar10MhzTiming {};
+struct DotStarEsp32DmaVspiMethod : DotStar10MhzTiming {};
+struct NeoWs2801Spi2MhzMethod : Ws2801Spi2MhzTiming {};
+
+/**
+ * @brief LED strip model: keeps the pixels in memory and occupies the bus after Show() for the time the real
+ * transfer takes (bits * bit time + start/end frames + reset/latch), so CanShow() reports the contention.
+ * Like the DMA drivers, Show() returns as soon as the transfer starts, but it waits for the previous transfer first:
+ * the virtual clock moves to the end of it (the wall clock is polled).
+ *
+ * @tparam T_COLOR_FEATURE color type
+ * @tparam T_METHOD bus timing
+ */
+template<typename T_COLOR_FEATURE, typename T_METHOD> class NeoPixelBus
+{
+	std::vector<typename T_COLOR_FEATURE::ColorObject> pixels;
+	uint32_t shows = 0;
+	uint32_t blockedShows = 0;
+	uint64_t busyUntil = 0;
+
+	public:
+		NeoPixelBus(uint16_t count, uint8_t = 0) : pixels(count) {}
+
+		void Begin() {}
+		void Begin(int8_t, int8_t, int8_t, int8_t) {}
+
+		/**
+		 * @brief Time of the whole transfer (ns)
+		 *
+		 * @return uint64_t
+		 */
+		uint64_t getBusNanos() const
+		{
+			uint64_t bits = (uint64_t)pixels.size() * T_COLOR_FEATURE::BitsPerPixel + T_METHOD::StartBits +
+							(pixels.size() + 15) / 16 * T_METHOD::EndBitsPer16Leds;
+
+			return bits * T_METHOD::BitNanos + T_METHOD::ResetNanos;
+		}
+
+		bool CanShow() const
+		{
+			return hostClockNanos() >= busyUntil;
+		}
+
+		void Show(bool = true)
+		{
+			uint64_t start = hostClockNanos();
+
+			// the real driver blocks until the previous transfer is done
+			if (start < busyUntil)
+			{
+				blockedShows++;
+				if (hostIsVirtualClock())
+					hostAdvanceClockTo(busyUntil);
+				else
+					while (hostClockNanos() < busyUntil);
+				start = busyUntil;
+			}
+
+			busyUntil = start + getBusNanos();
+			shows++;
+
+			if (hostShowHook != nullptr)
+				hostShowHook(this, (const uint8_t*)pixels.data(), pixels.size(), sizeof(typename T_COLOR_FEATURE::ColorObject));
+		}
+
+		uint16_t PixelCount() const
+		{
+			return (uint16_t)pixels.size();
+		}
+
+		void SetPixelColor(uint16_t index, typename T_COLOR_FEATURE::ColorObject color)
+		{
+			if (index < pixels.size())
+				pixels[index] = color;
+		}
+
+		typename T_COLOR_FEATURE::ColorObject GetPixelColor(uint16_t index) const
+		{
+			return (index < pixels.size()) ? pixels[index] : typename T_COLOR_FEATURE::ColorObject();
+		}
+
+		void ClearTo(typename T_COLOR_FEATURE::ColorObject color, uint16_t first, uint16_t last)
+		{
+			for (uint32_t i = first; i <= last && i < pixels.size(); i++)
+				pixels[i] = color;
+		}
+
+		uint8_t* Pixels()
+		{
+			return (uint8_t*)pixels.data();
+		}
+
+		size_t PixelsSize() const
+		{
+			return pixels.size() * sizeof(typename T_COLOR_FEATURE::ColorObject);
+		}
+
+		void Dirty()
+		{
+		}
+
+		uint32_t getShowCount() const
+		{
+			return shows;
+		}
+
+		// Show() calls that had to wait for the previous transfer
+		uint32_t getBlockedShowCount() const
+		{
+			return blockedShows;
+		}
+};
+
+#endif
@@ -0,0 +1,99 @@
+/* Preferences.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+/**
+ * @brief NVS preferences of the native build, kept in memory. Like the flash, the values survive the Preferences
+ * object: a new object (the firmware after the reboot) reads what the previous one wrote in the same namespace.
+ *
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences
+{
+	std::string name;
+
+	static std::map<std::string, std::vector<uint8_t>>& getFlash()
+	{
+		static std::map<std::string, std::vector<uint8_t>> flash;
+		return flash;
+	}
+
+	static uint32_t& getWrites()
+	{
+		static uint32_t writes = 0;
+		return writes;
+	}
+
+	public:
+		bool begin(const char* space, bool = false)
+		{
+			name = space;
+			return true;
+		}
+
+		void end()
+		{
+		}
+
+		size_t getBytes(const char* key, void* buffer, size_t size)
+		{
+			auto value = getFlash().find(name + "/" + key);
+
+			if (value == getFlash().end() || value->second.size() > size)
+				return 0;
+
+			memcpy(buffer, value->second.data(), value->second.size());
+			return value->second.size();
+		}
+
+		size_t putBytes(const char* key, const void* data, size_t size)
+		{
+			getFlash()[name + "/" + key].assign((const uint8_t*)data, (const uint8_t*)data + size);
+			getWrites()++;
+			return size;
+		}
+
+		/**
+		 * @brief Number of the flash writes (all namespaces)
+		 *
+		 * @return uint32_t
+		 */
+		static uint32_t getWriteCount()
+		{
+			return getWrites();
+		}
+};
+
+#endif
@@ -0,0 +1,84 @@
+/* semphr.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef HOST_FREERTOS_SEMPHR_H
+#define HOST_FREERTOS_SEMPHR_H
+
+/**
+ * @brief FreeRTOS binary semaphore of the native build
+ *
+ */
+
+#include <condition_variable>
+#include <mutex>
+#include "freertos/FreeRTOS.h"
+
+struct HostSemaphore
+{
+	std::mutex lock;
+	std::condition_variable signal;
+	bool given = false;
+};
+
+typedef HostSemaphore* SemaphoreHandle_t;
+typedef SemaphoreHandle_t xSemaphoreHandle;
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+	return new HostSemaphore();
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+	if (semaphore == nullptr)
+		return pdFALSE;
+
+	std::lock_guard<std::mutex> guard(semaphore->lock);
+	bool wasGiven = semaphore->given;
+
+	semaphore->given = true;
+	semaphore->signal.notify_one();
+	return (wasGiven) ? pdFALSE : pdTRUE;
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+	if (semaphore == nullptr)
+		return pdFALSE;
+
+	std::unique_lock<std::mutex> guard(semaphore->lock);
+
+	if (ticks == portMAX_DELAY)
+		semaphore->signal.wait(guard, [semaphore] { return semaphore->given; });
+	else if (!semaphore->signal.wait_for(guard, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), [semaphore] { return semaphore->given; }))
+		return pdFALSE;
+
+	semaphore->given = false;
+	return pdTRUE;
+}
+
+#endif
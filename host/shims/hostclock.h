@@ -0,0 +1,59 @@
+/* hostclock.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef HOST_CLOCK_H
+#define HOST_CLOCK_H
+
+/**
+ * @brief Clock of the native build. By default it's the monotonic wall clock. In the virtual mode the time moves
+ * only by hostAdvanceClock() and the esp_timer callbacks are called from it at their exact deadlines, so the tests,
+ * the replay and the benchmarks are deterministic.
+ *
+ */
+
+#include <stdint.h>
+
+#define HOST_CLOCK_NEVER UINT64_MAX
+
+// current time (ns)
+uint64_t hostClockNanos();
+
+// switch to the virtual clock starting at the given time (ns)
+void hostUseVirtualClock(uint64_t startNanos = 0);
+
+bool hostIsVirtualClock();
+
+// move the virtual clock forward, the due timers are called on the way
+void hostAdvanceClock(uint64_t nanos);
+
+// move the virtual clock to the given time if it's in the future
+void hostAdvanceClockTo(uint64_t nanos);
+
+// deadline of the nearest armed timer (ns) or HOST_CLOCK_NEVER
+uint64_t hostNextTimerDeadline();
+
+#endif
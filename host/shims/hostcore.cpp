@@ -0,0 +1,318 @@
+/* hostcore.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+/**
+ * @brief Runtime of the native build: clock, ESP object, serial port, tasks and timers
+ *
+ */
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <NeoPixelBus.h>
+#include <unity.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static std::atomic<bool> virtualClock(false);
+static std::atomic<uint64_t> virtualNanos(0);
+static std::atomic<int> pinLevels[64] = {};
+
+EspClass ESP;
+void (*hostShowHook)(const void* strip, const uint8_t* pixels, size_t count, int channels) = nullptr;
+bool hostPsramFound = false;
+uint32_t hostFailedHeapCaps = 0;
+HardwareSerial Serial;
+UnityState Unity;
+
+uint64_t hostClockNanos()
+{
+	static const auto start = std::chrono::steady_clock::now();
+
+	if (virtualClock)
+		return virtualNanos;
+
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void hostUseVirtualClock(uint64_t startNanos)
+{
+	virtualNanos = startNanos;
+	virtualClock = true;
+}
+
+bool hostIsVirtualClock()
+{
+	return virtualClock;
+}
+
+void HardwareSerial::attach(int input, int output)
+{
+	inputFd = input;
+	outputFd = output;
+	fcntl(inputFd, F_SETFL, fcntl(inputFd, F_GETFL) | O_NONBLOCK);
+	fcntl(outputFd, F_SETFL, fcntl(outputFd, F_GETFL) | O_NONBLOCK);
+}
+
+int HardwareSerial::available()
+{
+	int size = 0;
+
+	if (inputFd < 0)
+		return 0;
+
+	if (ioctl(inputFd, FIONREAD, &size) == 0 && size > 0)
+		return size;
+
+	struct pollfd request = { inputFd, POLLIN, 0 };
+
+	if (poll(&request, 1, 1) > 0 && ioctl(inputFd, FIONREAD, &size) == 0)
+		return size;
+
+	return 0;
+}
+
+size_t HardwareSerial::read(uint8_t* buffer, size_t size)
+{
+	if (inputFd < 0)
+		return 0;
+
+	ssize_t count = ::read(inputFd, buffer, size);
+	return (count > 0) ? count : 0;
+}
+
+int HardwareSerial::read()
+{
+	uint8_t data;
+
+	return (read(&data, 1) == 1) ? data : -1;
+}
+
+int HardwareSerial::availableForWrite()
+{
+	struct pollfd request = { outputFd, POLLOUT, 0 };
+
+	return (poll(&request, 1, 0) > 0 && (request.revents & POLLOUT)) ? 256 : 0;
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t size)
+{
+	ssize_t count = ::write(outputFd, data, size);
+
+	return (count > 0) ? count : 0;
+}
+
+void hostSetPinLevel(int pin, int value)
+{
+	if (pin >= 0 && pin < (int)(sizeof(pinLevels) / sizeof(pinLevels[0])))
+		pinLevels[pin] = value;
+}
+
+int hostGetPinLevel(int pin)
+{
+	return (pin >= 0 && pin < (int)(sizeof(pinLevels) / sizeof(pinLevels[0]))) ? pinLevels[pin].load() : LOW;
+}
+
+struct HostTask
+{
+	std::thread thread;
+};
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char*, uint32_t, void* parameters, UBaseType_t, TaskHandle_t* handle, BaseType_t)
+{
+	HostTask* hostTask = new HostTask();
+
+	hostTask->thread = std::thread(task, parameters);
+	hostTask->thread.detach();
+	if (handle != nullptr)
+		*handle = hostTask;
+	return pdPASS;
+}
+
+/**
+ * @brief One-shot timer: on the wall clock it's served by its own thread,
+ * on the virtual clock the callback is called by hostAdvanceClock()
+ *
+ */
+struct esp_timer
+{
+	esp_timer_cb_t callback;
+	void* arg;
+	std::mutex lock;
+	std::condition_variable signal;
+	std::thread worker;
+	// due time for the wall clock, deadline (ns) for the virtual clock
+	std::chrono::steady_clock::time_point due;
+	uint64_t deadline = 0;
+	bool armed = false;
+	// increased by every start, so a quick stop and start is never served with the old due time
+	uint64_t generation = 0;
+
+	void run()
+	{
+		std::unique_lock<std::mutex> guard(lock);
+
+		for (;;)
+		{
+			signal.wait(guard, [this] { return armed && !virtualClock; });
+
+			uint64_t started = generation;
+			if (!signal.wait_until(guard, due, [this, started] { return !armed || generation != started; }))
+			{
+				armed = false;
+				guard.unlock();
+				callback(arg);
+				guard.lock();
+			}
+		}
+	}
+};
+
+static std::mutex timersLock;
+static std::vector<esp_timer*> timers;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle)
+{
+	esp_timer* timer = new esp_timer();
+
+	timer->callback = args->callback;
+	timer->arg = args->arg;
+	timer->worker = std::thread(&esp_timer::run, timer);
+	timer->worker.detach();
+	{
+		std::lock_guard<std::mutex> guard(timersLock);
+		timers.push_back(timer);
+	}
+	*handle = timer;
+	return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout)
+{
+	std::lock_guard<std::mutex> guard(timer->lock);
+
+	if (timer->armed)
+		return ESP_FAIL;
+
+	timer->due = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout);
+	timer->deadline = hostClockNanos() + timeout * 1000;
+	timer->armed = true;
+	timer->generation++;
+	timer->signal.notify_all();
+	return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+	std::lock_guard<std::mutex> guard(timer->lock);
+
+	if (!timer->armed)
+		return ESP_FAIL;
+
+	timer->armed = false;
+	timer->signal.notify_all();
+	return ESP_OK;
+}
+
+int64_t esp_timer_get_time()
+{
+	return (int64_t)(hostClockNanos() / 1000);
+}
+
+/**
+ * @brief Find the armed timer with the nearest deadline
+ *
+ * @return esp_timer*
+ */
+static esp_timer* findNextTimer()
+{
+	std::lock_guard<std::mutex> guard(timersLock);
+	esp_timer* next = nullptr;
+
+	for (esp_timer* timer : timers)
+	{
+		std::lock_guard<std::mutex> timerGuard(timer->lock);
+
+		if (timer->armed && (next == nullptr || timer->deadline < next->deadline))
+			next = timer;
+	}
+
+	return next;
+}
+
+uint64_t hostNextTimerDeadline()
+{
+	esp_timer* next = findNextTimer();
+
+	if (next == nullptr)
+		return HOST_CLOCK_NEVER;
+
+	std::lock_guard<std::mutex> guard(next->lock);
+	return (next->armed) ? next->deadline : HOST_CLOCK_NEVER;
+}
+
+void hostAdvanceClockTo(uint64_t nanos)
+{
+	for (;;)
+	{
+		esp_timer* next = findNextTimer();
+
+		if (next == nullptr)
+			break;
+
+		{
+			std::unique_lock<std::mutex> guard(next->lock);
+
+			if (!next->armed || next->deadline > nanos)
+				break;
+
+			if (next->deadline > virtualNanos)
+				virtualNanos = next->deadline;
+			next->armed = false;
+		}
+
+		next->callback(next->arg);
+	}
+
+	if (nanos > virtualNanos)
+		virtualNanos = nanos;
+}
+
+void hostAdvanceClock(uint64_t nanos)
+{
+	hostAdvanceClockTo(virtualNanos + nanos);
+}
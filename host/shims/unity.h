@@ -0,0 +1,104 @@
+/* unity.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef HOST_UNITY_H
+#define HOST_UNITY_H
+
+/**
+ * @brief Subset of the Unity test framework for the native build. A failed assertion ends the current test.
+ *
+ */
+
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdio.h>
+
+struct UnityState
+{
+	const char* currentTest = nullptr;
+	int tests = 0;
+	int failures = 0;
+	jmp_buf abortTest;
+};
+
+extern UnityState Unity;
+
+inline void unityFail(const char* file, int line, const char* message)
+{
+	printf("%s:%d:%s:FAIL: %s\n", file, line, Unity.currentTest, (message != nullptr) ? message : "");
+	Unity.failures++;
+	longjmp(Unity.abortTest, 1);
+}
+
+inline void unityAssertEqual(long long expected, long long actual, const char* file, int line, const char* message)
+{
+	if (expected != actual)
+	{
+		char output[256];
+
+		snprintf(output, sizeof(output), "Expected %lld Was %lld. %s", expected, actual, (message != nullptr) ? message : "");
+		unityFail(file, line, output);
+	}
+}
+
+inline void unityRunTest(void (*test)(), const char* name, const char* file, int line)
+{
+	int failures = Unity.failures;
+
+	Unity.currentTest = name;
+	Unity.tests++;
+	if (setjmp(Unity.abortTest) == 0)
+		test();
+	if (failures == Unity.failures)
+		printf("%s:%d:%s:PASS\n", file, line, name);
+}
+
+inline int unityEnd()
+{
+	printf("-----------------------\n%d Tests %d Failures 0 Ignored\n%s\n", Unity.tests, Unity.failures, (Unity.failures == 0) ? "OK" : "FAIL");
+	return Unity.failures;
+}
+
+#define UNITY_BEGIN() (Unity.tests = 0, Unity.failures = 0)
+#define UNITY_END() unityEnd()
+#define RUN_TEST(func) unityRunTest(func, #func, __FILE__, __LINE__)
+
+#define TEST_FAIL_MESSAGE(message) unityFail(__FILE__, __LINE__, message)
+#define TEST_ASSERT_TRUE_MESSAGE(condition, message) do { if (!(condition)) unityFail(__FILE__, __LINE__, message); } while (0)
+#define TEST_ASSERT_TRUE(condition) TEST_ASSERT_TRUE_MESSAGE(condition, #condition)
+#define TEST_ASSERT_FALSE(condition) TEST_ASSERT_TRUE_MESSAGE(!(condition), #condition)
+#define TEST_ASSERT_EQUAL_MESSAGE(expected, actual, message) TEST_ASSERT_TRUE_MESSAGE((expected) == (actual), message)
+#define TEST_ASSERT_EQUAL_INT_MESSAGE(expected, actual, message) unityAssertEqual((long long)(expected), (long long)(actual), __FILE__, __LINE__, message)
+#define TEST_ASSERT_EQUAL_INT(expected, actual) TEST_ASSERT_EQUAL_INT_MESSAGE(expected, actual, nullptr)
+#define TEST_ASSERT_EQUAL_UINT8(expected, actual) TEST_ASSERT_EQUAL_INT_MESSAGE((uint8_t)(expected), (uint8_t)(actual), nullptr)
+#define TEST_ASSERT_EQUAL_UINT16(expected, actual) TEST_ASSERT_EQUAL_INT_MESSAGE((uint16_t)(expected), (uint16_t)(actual), nullptr)
+#define TEST_ASSERT_EQUAL_UINT32(expected, actual) TEST_ASSERT_EQUAL_INT_MESSAGE((uint32_t)(expected), (uint32_t)(actual), nullptr)
+#define TEST_ASSERT_LESS_THAN_MESSAGE(threshold, actual, message) TEST_ASSERT_TRUE_MESSAGE((actual) < (threshold), message)
+#define TEST_ASSERT_LESS_THAN(threshold, actual) TEST_ASSERT_LESS_THAN_MESSAGE(threshold, actual, "Expected less than " #threshold)
+#define TEST_ASSERT_GREATER_THAN(threshold, actual) TEST_ASSERT_TRUE_MESSAGE((actual) > (threshold), "Expected greater than " #threshold)
+
+#endif
@@ -0,0 +1,246 @@
+/* taskharness.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+/**
+ * @brief Stress harness of the two firmware tasks: the unmodified src/main.cpp runs processSerialTask and
+ * processDataTask on two threads with the same semaphore handoff as on the device. The feeder thread writes
+ * valid frames, frames with bad checksums and statistics requests in random chunks to the serial port (a pipe).
+ * Built with ThreadSanitizer it reports the data races between the tasks, without it still checks the ordering:
+ * every frame must be decoded, every shown frame must be one of the sent frames in the sending order, and the
+ * last frame must be shown.
+ *
+ * Usage: hyperserial_tasks [--frames N] [--leds N] [--seed N]
+ *
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include "../../src/main.cpp"
+#include "benchmark.h"
+
+static std::mutex harnessLock;
+static std::unordered_map<uint64_t, int> expectedFrames;
+static int lastShown = -1;
+static int shownFrames = 0;
+static int unknownFrames = 0;
+static int reorderedFrames = 0;
+static std::vector<uint8_t> framePixels;
+static std::atomic<int> responses(0);
+
+static uint64_t hashPixels(const uint8_t* data, size_t size)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+
+	for (size_t i = 0; i < size; i++)
+		hash = (hash ^ data[i]) * 0x100000001b3ULL;
+	return hash;
+}
+
+/**
+ * @brief The colors of the frame as they appear on the strips: segment 1, then segment 2 (reversed)
+ *
+ */
+static uint64_t hashShownFrame(const std::vector<uint8_t>& frame, int leds)
+{
+	std::vector<uint8_t> pixels(frame.begin() + 6, frame.begin() + 6 + leds * 3);
+
+	#if defined(SECOND_SEGMENT_REVERSED)
+		for (int i = SECOND_SEGMENT_START_INDEX, j = leds - 1; i < j; i++, j--)
+			for (int c = 0; c < 3; c++)
+				std::swap(pixels[i * 3 + c], pixels[j * 3 + c]);
+	#endif
+
+	return hashPixels(pixels.data(), pixels.size());
+}
+
+static void onShow(const void* strip, const uint8_t* pixels, size_t count, int channels)
+{
+	std::lock_guard<std::mutex> guard(harnessLock);
+
+	if (strip == base.getLedStrip1())
+		framePixels.assign(pixels, pixels + count * channels);
+	else
+		framePixels.insert(framePixels.end(), pixels, pixels + count * channels);
+
+	if (base.getLedStrip2() != nullptr && strip != (const void*)base.getLedStrip2())
+		return;
+
+	auto found = expectedFrames.find(hashPixels(framePixels.data(), framePixels.size()));
+
+	shownFrames++;
+	if (found == expectedFrames.end())
+		unknownFrames++;
+	else if (found->second <= lastShown)
+		reorderedFrames++;
+	else
+		lastShown = found->second;
+}
+
+/**
+ * @brief Count the statistics responses of the device
+ *
+ */
+static void readOutput(int fd)
+{
+	std::string text;
+	char buffer[1024];
+
+	for (;;)
+	{
+		ssize_t count = read(fd, buffer, sizeof(buffer));
+
+		if (count <= 0)
+			return;
+
+		text.append(buffer, count);
+		for (size_t found; (found = text.find("HyperHDR frames:")) != std::string::npos; text.erase(0, found + 1))
+			responses++;
+		if (text.size() > 64)
+			text.erase(0, text.size() - 64);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int frames = 2000, leds = 300;
+	uint32_t seed = 1;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--frames") == 0)
+			frames = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--leds") == 0)
+			leds = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--seed") == 0)
+			seed = (uint32_t)atol(argv[i + 1]);
+		else
+		{
+			fprintf(stderr, "Unknown option: %s\n", argv[i]);
+			return 2;
+		}
+	}
+
+	#if defined(SECOND_SEGMENT_START_INDEX)
+		if (leds <= SECOND_SEGMENT_START_INDEX)
+		{
+			fprintf(stderr, "The frame must cover both segments (more than %d LEDs)\n", SECOND_SEGMENT_START_INDEX);
+			return 2;
+		}
+	#endif
+
+	// the stream: every 7th frame has a bad checksum, every 100th frame is followed by the statistics request
+	std::mt19937 random(seed);
+	std::vector<std::vector<uint8_t>> stream;
+	int validFrames = 0, lastValid = -1, statsRequests = 0;
+
+	for (int i = 0; i < frames; i++)
+	{
+		std::vector<uint8_t> frame = createAwaFrame(leds, false, seed * 100003 + i);
+
+		if (i % 7 == 3 && i != frames - 1)
+			frame[6 + random() % (leds * 3)] ^= 0x5a;
+		else
+		{
+			expectedFrames[hashShownFrame(frame, leds)] = i;
+			lastValid = i;
+			validFrames++;
+		}
+		stream.push_back(frame);
+
+		if (i % 100 == 50 && i != frames - 1)
+		{
+			std::vector<uint8_t> command(AwaEncoder::COMMAND_SIZE);
+
+			AwaEncoder::encodeCommand(command.data(), command.size(), 0x15);
+			stream.push_back(command);
+			statsRequests++;
+		}
+	}
+
+	int input[2], output[2];
+	if (pipe(input) != 0 || pipe(output) != 0)
+	{
+		perror("Cannot create the pipes");
+		return 1;
+	}
+	fcntl(input[1], F_SETPIPE_SZ, 1 << 16);
+
+	hostShowHook = onShow;
+	Serial.attach(input[0], output[1]);
+	std::thread(readOutput, output[0]).detach();
+
+	setup();
+
+	// feeder: random chunks with random pauses, so the tasks meet at different points of the frame
+	std::thread feeder([&]()
+	{
+		std::mt19937 timing(seed);
+
+		for (const std::vector<uint8_t>& frame : stream)
+			for (size_t sent = 0; sent < frame.size(); )
+			{
+				size_t chunk = std::min(frame.size() - sent, (size_t)(1 + timing() % 2048));
+				ssize_t count = write(input[1], frame.data() + sent, chunk);
+
+				if (count > 0)
+					sent += count;
+				if (timing() % 8 == 0)
+					std::this_thread::sleep_for(std::chrono::microseconds(timing() % 500));
+			}
+	});
+	feeder.join();
+
+	// wait for the last frame: the LED bus can skip the frames in between, but never the last one
+	bool finished = false;
+	for (int wait = 0; wait < 1000 && !finished; wait++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		std::lock_guard<std::mutex> guard(harnessLock);
+		finished = (lastShown == lastValid);
+	}
+
+	std::lock_guard<std::mutex> guard(harnessLock);
+	uint32_t goodFrames = statistics.lifetime.goodFrames;
+	uint32_t checksumErrors = errorStatistics.getChecksumErrors();
+	bool passed = finished && unknownFrames == 0 && reorderedFrames == 0 && goodFrames == (uint32_t)validFrames &&
+				checksumErrors == (uint32_t)(frames - validFrames) && (statsRequests == 0 || responses > 0);
+
+	printf("{\n  \"frames\": %d, \"valid\": %d, \"good\": %u, \"checksum_errors\": %u,\n"
+			"  \"shown\": %d, \"unknown\": %d, \"reordered\": %d, \"last_shown\": %s,\n"
+			"  \"stats_requests\": %d, \"responses\": %d,\n  \"result\": \"%s\"\n}\n",
+			frames, validFrames, goodFrames, checksumErrors, shownFrames, unknownFrames, reorderedFrames,
+			(finished) ? "true" : "false", statsRequests, responses.load(), (passed) ? "passed" : "failed");
+	fflush(stdout);
+
+	// the tasks never end: leave without the static destructors
+	_exit((passed) ? 0 : 1);
+}
@@ -0,0 +1,222 @@
+/* hosttest.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef HOSTTEST_H
+#define HOSTTEST_H
+
+/**
+ * @brief Common part of the host tests on the virtual clock: the serial port mockup delivering the data in chunks,
+ * the firmware, the capture of the frames sent to the LED strip and the helpers that run the tasks.
+ * The test defines its LED type (and the options) before including it.
+ *
+ */
+
+#define HYPERSERIAL_TESTING
+
+#include <Arduino.h>
+#include <NeoPixelBus.h>
+#include <unity.h>
+#include "benchmark.h"
+#include "awarecord.h"
+
+// bytes read by the serial task at once
+#if !defined(HOST_TEST_CHUNK)
+	#define HOST_TEST_CHUNK 120
+#endif
+
+/**
+ * @brief Mockup Serial class: delivers the queued data in chunks
+ *
+ */
+class SerialTester
+{
+	std::vector<uint8_t> data;
+	size_t sent = 0;
+
+	public:
+		void send(const std::vector<uint8_t>& frame)
+		{
+			data = frame;
+			sent = 0;
+		}
+
+		int available()
+		{
+			return (int)std::min(data.size() - sent, (size_t)HOST_TEST_CHUNK);
+		}
+
+		int toSend()
+		{
+			return (int)(data.size() - sent);
+		}
+
+		size_t read(uint8_t* buffer, size_t size)
+		{
+			size_t count = std::min(data.size() - sent, size);
+
+			memcpy(buffer, data.data() + sent, count);
+			sent += count;
+			return count;
+		}
+
+		int availableForWrite()
+		{
+			return 0;
+		}
+
+		size_t write(const uint8_t*, size_t size)
+		{
+			return size;
+		}
+
+		size_t print(const char*)
+		{
+			return 0;
+		}
+
+		size_t println(const char*)
+		{
+			return 0;
+		}
+} SerialPort;
+
+#if defined(NEOPIXEL_RGBW)
+	#define LED_DRIVER NeoPixelBus<NeoGrbwFeature, NeoEsp32I2s0Sk6812Method>
+	#define LED_DRIVER2 NeoPixelBus<NeoGrbwFeature, NeoEsp32I2s1Sk6812Method>
+#else
+	#define LED_DRIVER NeoPixelBus<NeoGrbFeature, NeoEsp32I2s0Ws2812xMethod>
+	#define LED_DRIVER2 NeoPixelBus<NeoGrbFeature, NeoEsp32I2s1Ws2812xMethod>
+#endif
+#include "main.h"
+
+// woken up by the render timer
+xSemaphoreHandle wakeup = nullptr;
+int wakeups = 0;
+
+/**
+ * @brief The frames sent to the LED strip: the time and the color of the first LED
+ *
+ */
+struct ShownFrame
+{
+	unsigned long time;
+	uint8_t red;
+	uint8_t green;
+	uint8_t blue;
+};
+
+std::vector<ShownFrame> shownFrames;
+
+void onShow(const void*, const uint8_t* pixels, size_t, int)
+{
+	shownFrames.push_back({ micros(), pixels[0], pixels[1], pixels[2] });
+}
+
+/**
+ * @brief Let the serial task take the data, one chunk every given time
+ *
+ * @param data
+ * @param chunkInterval us
+ * @return unsigned long micros() of the first chunk
+ */
+unsigned long readSerial(const std::vector<uint8_t>& data, unsigned long chunkInterval = 0)
+{
+	unsigned long start = micros();
+
+	SerialPort.send(data);
+	while(SerialPort.toSend() > 0)
+	{
+		serialTaskHandler();
+		if (SerialPort.toSend() > 0 && chunkInterval > 0)
+			hostAdvanceClock(chunkInterval * 1000ULL);
+	}
+	return start;
+}
+
+/**
+ * @brief Let the serial task take the data and the processing task decode it
+ *
+ * @param data
+ */
+void receive(const std::vector<uint8_t>& data)
+{
+	readSerial(data);
+	processData();
+}
+
+/**
+ * @brief Send the control command (0x2aa2 header)
+ *
+ * @param code
+ */
+void sendCommand(uint8_t code)
+{
+	uint8_t command[AwaEncoder::COMMAND_SIZE];
+
+	AwaEncoder::encodeCommand(command, sizeof(command), code);
+	receive(std::vector<uint8_t>(command, command + sizeof(command)));
+}
+
+/**
+ * @brief Advance the virtual clock, run the processing task every time the render timer wakes it up
+ *
+ * @param nanos
+ * @param untilShown stop when the frame is shown
+ */
+void runFor(uint64_t nanos, bool untilShown = false)
+{
+	uint64_t end = hostClockNanos() + nanos;
+	uint32_t shown = statistics.lifetime.showFrames;
+
+	while (hostNextTimerDeadline() <= end)
+	{
+		hostAdvanceClockTo(hostNextTimerDeadline());
+		if (xSemaphoreTake(wakeup, 0) == pdTRUE)
+		{
+			wakeups++;
+			processData();
+		}
+
+		if (untilShown && statistics.lifetime.showFrames != shown)
+			return;
+	}
+	hostAdvanceClockTo(end);
+}
+
+/**
+ * @brief Start the virtual clock, the render timer and the capture of the shown frames
+ *
+ */
+void hostTestBegin()
+{
+	hostUseVirtualClock(1000000000ULL);
+	wakeup = xSemaphoreCreateBinary();
+	renderScheduler.begin(wakeup);
+	hostShowHook = onShow;
+}
+
+#endif
@@ -0,0 +1,175 @@
+/* main.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#define NEOPIXEL_RGB 1
+#define FAST_BOOT 1
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+#include <thread>
+
+// the firmware entry points are called by the test
+#define setup firmwareSetup
+#define loop firmwareLoop
+#include "../../../src/main.cpp"
+#undef setup
+#undef loop
+
+#include <unity.h>
+#include "benchmark.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////// FAST BOOT TEST ///////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+// the host sends the first frame 5ms after the reset
+#define FIRST_BYTE_US 5000
+
+// the serial port: the host writes to input[1] and reads output[0]
+int input[2], output[2];
+std::string received;
+
+/**
+ * @brief Read what the device sent until the text appears
+ *
+ * @param text
+ * @param timeout ms
+ * @return true if the text was received
+ */
+bool waitForOutput(const char* text, int timeout)
+{
+	char buffer[256];
+
+	for (int wait = 0; wait < timeout; wait++)
+	{
+		ssize_t count;
+
+		while ((count = read(output[0], buffer, sizeof(buffer))) > 0)
+			received.append(buffer, count);
+
+		if (received.find(text) != std::string::npos)
+			return true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return false;
+}
+
+/**
+ * @brief Nobody reads the serial port (the host is not connected yet): setup() doesn't wait for it
+ * and has no fixed delays, the virtual clock doesn't move
+ *
+ */
+void FastBootTest_SetupDoesNotWaitForPort()
+{
+	char filler[256] = {};
+
+	// fill the output until the port accepts nothing more
+	while (write(output[1], filler, sizeof(filler)) > 0)
+		continue;
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, Serial.availableForWrite(), "The port should be full");
+
+	firmwareSetup();
+
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, micros(), "setup() should not wait");
+	TEST_ASSERT_TRUE_MESSAGE(!txQueue.isEmpty(), "The startup messages should be queued");
+	TEST_ASSERT_TRUE_MESSAGE(base.processDataHandle != nullptr && base.processSerialHandle != nullptr, "The tasks should be started");
+}
+
+/**
+ * @brief The serial task sends the queued startup messages when the port accepts them
+ *
+ */
+void FastBootTest_MessagesSentByTask()
+{
+	TEST_ASSERT_TRUE_MESSAGE(waitForOutput(HELLO_MESSAGE, 1000), "The startup messages should be sent by the serial task");
+	TEST_ASSERT_TRUE_MESSAGE(waitForOutput("NeoPixelBus ws281x type (GRB).\r\n", 1000), "The LED type should be sent");
+}
+
+/**
+ * @brief The first frame FIRST_BYTE_US after the reset is decoded and shown
+ *
+ */
+void FastBootTest_FirstFrame()
+{
+	std::vector<uint8_t> frame = createAwaFrame(300, false, 1);
+
+	hostAdvanceClock(FIRST_BYTE_US * 1000ULL);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(frame.size(), write(input[1], frame.data(), frame.size()), "The frame should be sent");
+
+	for (int wait = 0; wait < 1000 && statistics.lifetime.showFrames == 0; wait++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, statistics.lifetime.goodFrames, "The first frame should be received");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, statistics.lifetime.showFrames, "The first frame should be shown");
+}
+
+/**
+ * @brief The statistics report when the device was ready and when it took the first byte
+ *
+ */
+void FastBootTest_BootReport()
+{
+	uint8_t command[AwaEncoder::COMMAND_SIZE];
+	char report[96];
+
+	AwaEncoder::encodeCommand(command, sizeof(command), 0x15);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(sizeof(command), write(input[1], command, sizeof(command)), "The command should be sent");
+
+	snprintf(report, sizeof(report), "Boot: ready after 0 us, first byte after %u us\r\n", FIRST_BYTE_US);
+	TEST_ASSERT_TRUE_MESSAGE(waitForOutput(report, 1000), "Incorrect boot times");
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////// UNIT TEST ROUTINES //////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+void setup()
+{
+	if (pipe(input) != 0 || pipe(output) != 0)
+	{
+		perror("Cannot create the pipes");
+		exit(1);
+	}
+	fcntl(output[0], F_SETFL, fcntl(output[0], F_GETFL) | O_NONBLOCK);
+	Serial.attach(input[0], output[1]);
+
+	// the reset, time 0
+	hostUseVirtualClock(0);
+
+	UNITY_BEGIN();
+	RUN_TEST(FastBootTest_SetupDoesNotWaitForPort);
+	RUN_TEST(FastBootTest_MessagesSentByTask);
+	RUN_TEST(FastBootTest_FirstFrame);
+	RUN_TEST(FastBootTest_BootReport);
+	UNITY_END();
+}
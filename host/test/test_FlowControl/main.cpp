@@ -0,0 +1,505 @@
+/* main.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#define HYPERSERIAL_TESTING
+#define NEOPIXEL_RGB
+
+// XON/XOFF by default, the RTS line variant is built with FLOW_CONTROL_RTS_PIN
+#if !defined(FLOW_CONTROL_RTS_PIN)
+	#define FLOW_CONTROL_XONXOFF
+#endif
+
+#include <Arduino.h>
+#include <NeoPixelBus.h>
+#include <unity.h>
+#include <deque>
+#include "benchmark.h"
+#include "awarecord.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+////////////////////// FLOW CONTROL UNDER SUSTAINED OVERRUN ///////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+#define TEST_LEDS_NUMBER 300
+#define TEST_FRAMES 400
+// 2Mb: 10 bits per byte
+#define BYTE_NANOS 5000ULL
+// the serial task runs every 1ms, the processing task is blocked for 120ms at a time (slower than the link)
+#define SERIAL_PERIOD_NANOS 1000000ULL
+#define PROCESS_PERIOD_NANOS 120000000ULL
+// the host keeps sending for 4ms after the stop request (USB latency, its own FIFO)
+#define HOST_REACTION_NANOS 4000000ULL
+
+/**
+ * @brief Mockup Serial class: the UART link on the virtual clock. The host sends at the line speed to the serial driver
+ * buffer (MAX_BUFFER - 1 bytes like setRxBufferSize) and the bytes that don't fit are lost.
+ * The host stops HOST_REACTION_NANOS after the device asked for it, unless it ignores the flow control.
+ *
+ */
+class SerialTester
+{
+	std::vector<uint8_t> stream;
+	size_t sent = 0;
+	std::deque<uint8_t> driver;
+	uint64_t nextByte = 0;
+	uint64_t stopSeen = HOST_CLOCK_NEVER;
+	bool xoff = false;
+	bool overflow = false;
+
+	public:
+		bool honour = true;
+		size_t lost = 0;
+
+		void send(const std::vector<uint8_t>& data)
+		{
+			stream = data;
+			sent = 0;
+			driver.clear();
+			nextByte = hostClockNanos();
+			stopSeen = HOST_CLOCK_NEVER;
+			lost = 0;
+		}
+
+		bool isDone()
+		{
+			return sent == stream.size() && driver.empty();
+		}
+
+		// the host port received XOFF (and no XON after it)
+		bool isXoff()
+		{
+			return xoff;
+		}
+
+		// the serial driver reported the full buffer since the last call
+		bool takeOverflow()
+		{
+			bool result = overflow;
+
+			overflow = false;
+			return result;
+		}
+
+		void transfer(uint64_t now);
+
+		int available()
+		{
+			return (int)driver.size();
+		}
+
+		size_t read(uint8_t* buffer, size_t size)
+		{
+			size_t count = std::min(driver.size(), size);
+
+			std::copy(driver.begin(), driver.begin() + count, buffer);
+			driver.erase(driver.begin(), driver.begin() + count);
+			return count;
+		}
+
+		int availableForWrite()
+		{
+			return 1024;
+		}
+
+		size_t write(const uint8_t* data, size_t size);
+
+		size_t write(uint8_t data)
+		{
+			return write(&data, 1);
+		}
+
+		size_t print(const char*)
+		{
+			return 0;
+		}
+
+		size_t println(const char*)
+		{
+			return 0;
+		}
+} SerialPort;
+
+#define LED_DRIVER NeoPixelBus<NeoGrbFeature, NeoEsp32I2s0Ws2812xMethod>
+#define LED_DRIVER2 NeoPixelBus<NeoGrbFeature, NeoEsp32I2s1Ws2812xMethod>
+#include "main.h"
+
+// the acknowledgements that reach the host port
+AwaRecordReceiver ackReceiver(ACK_RECORD_TYPE);
+
+/**
+ * @brief The device output: the host port takes the flow control characters (IXON), the rest goes to the acknowledgement receiver
+ *
+ */
+size_t SerialTester::write(const uint8_t* data, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+		if (data[i] == FLOW_CONTROL_XOFF || data[i] == FLOW_CONTROL_XON)
+			xoff = (data[i] == FLOW_CONTROL_XOFF);
+	#if defined(FLOW_CONTROL_XONXOFF)
+		// the host port with IXON takes the flow control characters for itself
+		std::vector<uint8_t> received;
+
+		for (size_t i = 0; i < size; i++)
+			if (data[i] != FLOW_CONTROL_XOFF && data[i] != FLOW_CONTROL_XON)
+				received.push_back(data[i]);
+		ackReceiver.write(received.data(), received.size());
+	#else
+		ackReceiver.write(data, size);
+	#endif
+	return size;
+}
+
+/**
+ * @brief Move the bytes sent by the host until now to the serial driver buffer
+ *
+ * @param now
+ */
+void SerialTester::transfer(uint64_t now)
+{
+	#if defined(FLOW_CONTROL_RTS_PIN)
+		bool stop = (digitalRead(FLOW_CONTROL_RTS_PIN) == HIGH);
+	#else
+		bool stop = xoff;
+	#endif
+
+	if (!stop || !honour)
+		stopSeen = HOST_CLOCK_NEVER;
+	else if (stopSeen == HOST_CLOCK_NEVER)
+		stopSeen = now;
+
+	while (sent < stream.size() && nextByte <= now)
+	{
+		if (stopSeen != HOST_CLOCK_NEVER && nextByte >= stopSeen + HOST_REACTION_NANOS)
+			break;
+
+		if (driver.size() < MAX_BUFFER - 1)
+			driver.push_back(stream[sent]);
+		else
+		{
+			lost++;
+			overflow = true;
+		}
+		sent++;
+		nextByte += BYTE_NANOS;
+	}
+
+	// the idle line: the next byte can start right away
+	if (nextByte < now)
+		nextByte = now;
+}
+
+/**
+ * @brief Create the stream of the frames
+ *
+ * @return std::vector<uint8_t>
+ */
+std::vector<uint8_t> createStream()
+{
+	std::vector<uint8_t> stream;
+
+	for (int i = 0; i < TEST_FRAMES; i++)
+	{
+		std::vector<uint8_t> frame = createAwaFrame(TEST_LEDS_NUMBER, false, i);
+		stream.insert(stream.end(), frame.begin(), frame.end());
+	}
+	return stream;
+}
+
+/**
+ * @brief Run the serial task every 1ms and the processing task every 120ms until the host sent everything
+ *
+ */
+void runLink()
+{
+	uint64_t start = hostClockNanos();
+	uint64_t lastProcess = start;
+
+	while (!SerialPort.isDone() || base.queueCurrent != base.queueEnd)
+	{
+		hostAdvanceClock(SERIAL_PERIOD_NANOS);
+		SerialPort.transfer(hostClockNanos());
+		if (SerialPort.takeOverflow())
+			base.dataLost = true;
+		serialTaskHandler();
+
+		if (hostClockNanos() - lastProcess >= PROCESS_PERIOD_NANOS)
+		{
+			processData();
+			lastProcess = hostClockNanos();
+		}
+
+		TEST_ASSERT_TRUE_MESSAGE(hostClockNanos() - start < 60000000000ULL, "The link should finish");
+	}
+	processData();
+}
+
+/**
+ * @brief The host honours the flow control: every byte and every frame arrives although the decoder is slower than the link
+ *
+ */
+void FlowControlTest_ZeroLossUnderOverrun()
+{
+	uint32_t good = statistics.lifetime.goodFrames;
+	uint32_t checksumErrors = errorStatistics.getChecksumErrors();
+	uint32_t overruns = errorStatistics.getTotal(ErrorType::RING_OVERRUN);
+	uint32_t stops = flowControl.getStops();
+
+	SerialPort.honour = true;
+	SerialPort.send(createStream());
+	runLink();
+
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, SerialPort.lost, "No byte should be lost");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(good + TEST_FRAMES, statistics.lifetime.goodFrames, "Every frame should be received");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(checksumErrors, errorStatistics.getChecksumErrors(), "There should be no checksum errors");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(overruns, errorStatistics.getTotal(ErrorType::RING_OVERRUN), "The data buffer should never be full");
+	TEST_ASSERT_TRUE_MESSAGE(flowControl.getStops() > stops + 10, "The host should be stopped repeatedly");
+	TEST_ASSERT_TRUE_MESSAGE(!flowControl.isStopped(), "The host should be released at the end");
+}
+
+/**
+ * @brief The same link without the flow control overruns the serial driver: the test case is a real overrun
+ *
+ */
+void FlowControlTest_OverrunWithoutFlowControl()
+{
+	uint32_t good = statistics.lifetime.goodFrames;
+
+	SerialPort.honour = false;
+	SerialPort.send(createStream());
+	runLink();
+
+	TEST_ASSERT_TRUE_MESSAGE(SerialPort.lost > 0, "The serial driver buffer should overflow");
+	TEST_ASSERT_TRUE_MESSAGE(statistics.lifetime.goodFrames - good < TEST_FRAMES, "Some frames should be lost");
+}
+
+/**
+ * @brief The serial task polls the full data buffer many times: the overrun is counted once per episode
+ *
+ */
+void FlowControlTest_OverrunCountedOnce()
+{
+	uint32_t overruns = errorStatistics.getTotal(ErrorType::RING_OVERRUN);
+
+	SerialPort.honour = false;
+	SerialPort.send(createStream());
+
+	for (int episode = 1; episode <= 2; episode++)
+	{
+		for (int i = 0; i < 100; i++)
+		{
+			hostAdvanceClock(SERIAL_PERIOD_NANOS);
+			SerialPort.transfer(hostClockNanos());
+			serialTaskHandler();
+		}
+		TEST_ASSERT_EQUAL_INT_MESSAGE(overruns + episode, errorStatistics.getTotal(ErrorType::RING_OVERRUN),
+										"The full data buffer should be counted once");
+
+		// the decoder catches up, the next read fits
+		processData();
+		serialTaskHandler();
+	}
+
+	// let the rest of the stream go
+	runLink();
+}
+
+/**
+ * @brief The serial driver loses the end of the frame: the decoder abandons it exactly at the gap,
+ * also when the gap is in the middle of the data it decodes at once
+ *
+ */
+void FlowControlTest_LossAbandonsFrame()
+{
+	std::vector<uint8_t> lostFrame = createAwaFrame(TEST_LEDS_NUMBER, false, 10);
+	std::vector<uint8_t> nextFrame = createAwaFrame(TEST_LEDS_NUMBER, false, 11);
+	uint32_t good = statistics.lifetime.goodFrames;
+	uint32_t checksumErrors = errorStatistics.getChecksumErrors();
+
+	hostAdvanceClock(PROCESS_PERIOD_NANOS);
+	processData();
+	SerialPort.honour = true;
+
+	for (int batch = 0; batch < 2; batch++)
+	{
+		size_t half = lostFrame.size() / 2;
+
+		// the first half is taken, the rest is lost in the driver
+		SerialPort.send(std::vector<uint8_t>(lostFrame.begin(), lostFrame.begin() + half));
+		SerialPort.transfer(hostClockNanos() + half * BYTE_NANOS);
+		serialTaskHandler();
+		if (batch == 0)
+			processData();
+
+		SerialPort.send(std::vector<uint8_t>(lostFrame.begin() + half, lostFrame.end()));
+		SerialPort.transfer(hostClockNanos() + lostFrame.size() * BYTE_NANOS);
+		base.dataLost = true;
+		serialTaskHandler();
+
+		SerialPort.send(nextFrame);
+		SerialPort.transfer(hostClockNanos() + nextFrame.size() * BYTE_NANOS);
+		serialTaskHandler();
+		processData();
+
+		TEST_ASSERT_EQUAL_INT_MESSAGE(good + batch + 1, statistics.lifetime.goodFrames, "The frame after the gap should be received");
+		TEST_ASSERT_EQUAL_INT_MESSAGE(checksumErrors, errorStatistics.getChecksumErrors(), "The abandoned frame is not a checksum error");
+		TEST_ASSERT_EQUAL_INT_MESSAGE(-1, base.lossPosition, "The loss should be handled");
+
+		hostAdvanceClock(PROCESS_PERIOD_NANOS);
+		processData();
+	}
+}
+
+std::vector<int> occupancyAtShow;
+
+void onShow(const void*, const uint8_t*, size_t, int)
+{
+	occupancyAtShow.push_back((base.queueEnd - base.queueCurrent + MAX_BUFFER) % MAX_BUFFER);
+}
+
+/**
+ * @brief The decoder gives the consumed space back while it decodes a long batch, not only when it catches up
+ *
+ */
+void FlowControlTest_SpaceReleasedDuringBatch()
+{
+	std::vector<uint8_t> stream;
+
+	for (int i = 0; i < 3; i++)
+	{
+		std::vector<uint8_t> frame = createAwaFrame(TEST_LEDS_NUMBER, false, i);
+		stream.insert(stream.end(), frame.begin(), frame.end());
+	}
+
+	// no frame is waiting for the LED strip and it's free again
+	hostAdvanceClock(PROCESS_PERIOD_NANOS);
+	processData();
+	hostAdvanceClock(PROCESS_PERIOD_NANOS);
+	SerialPort.honour = true;
+	SerialPort.send(stream);
+	SerialPort.transfer(hostClockNanos() + stream.size() * BYTE_NANOS);
+	serialTaskHandler();
+
+	occupancyAtShow.clear();
+	hostShowHook = onShow;
+	processData();
+	hostShowHook = nullptr;
+
+	TEST_ASSERT_TRUE_MESSAGE(occupancyAtShow.size() > 0, "The first frame should be shown");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(stream.size() / 3 * 2, occupancyAtShow[0], "The decoded frame should be released before it's shown");
+}
+
+/**
+ * @brief The binary records can contain 0x11/0x13: with the XON/XOFF flow control they are escaped
+ *
+ */
+void FlowControlTest_BinaryRecords()
+{
+	const uint8_t payload[4] = { FLOW_CONTROL_XOFF, RECORD_ESCAPE, 0x00, FLOW_CONTROL_XON };
+	AwaRecordReceiver receiver('T');
+
+	txQueue.flush(SerialPort);
+
+	TEST_ASSERT_TRUE_MESSAGE(txQueue.writeRecord('T', payload, sizeof(payload)), "The binary record should be queued");
+	txQueue.flush(receiver);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, receiver.count, "The binary record should be received");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(sizeof(payload), receiver.size, "Incorrect size of the binary record");
+	TEST_ASSERT_TRUE_MESSAGE(memcmp(payload, receiver.last, sizeof(payload)) == 0, "Incorrect payload of the binary record");
+
+	TEST_ASSERT_TRUE_MESSAGE(txQueue.writeRecord('T', payload, sizeof(payload)), "The binary record should be queued");
+	txQueue.flush(SerialPort);
+	#if defined(FLOW_CONTROL_XONXOFF)
+		TEST_ASSERT_EQUAL_MESSAGE(flowControl.isStopped(), SerialPort.isXoff(), "Only the flow control should stop the host");
+	#endif
+}
+
+/**
+ * @brief The host that keeps a window of the sequenced frames gets every acknowledgement through its port,
+ * also for the sequence numbers made of the flow control characters
+ *
+ */
+void FlowControlTest_SequencedFrames()
+{
+	const uint16_t sequences[3] = { 0x1311, 0x7d13, 0x1113 };
+	std::vector<uint8_t> rgb(TEST_LEDS_NUMBER * 3, 0x13);
+	std::vector<uint8_t> stream;
+
+	for (uint16_t sequence : sequences)
+	{
+		std::vector<uint8_t> frame(AwaEncoder::getFrameSize(TEST_LEDS_NUMBER, false, true));
+
+		AwaEncoder::encodeSequencedFrame(frame.data(), frame.size(), rgb.data(), TEST_LEDS_NUMBER, sequence);
+		stream.insert(stream.end(), frame.begin(), frame.end());
+	}
+
+	txQueue.flush(SerialPort);
+	ackReceiver.count = 0;
+
+	SerialPort.honour = true;
+	SerialPort.send(stream);
+	runLink();
+	// the LED strip is free again for the last frame
+	hostAdvanceClock(PROCESS_PERIOD_NANOS);
+	processData();
+	txQueue.flush(SerialPort);
+
+	AckRecord ack = ackReceiver.getLast<AckRecord>();
+
+	TEST_ASSERT_TRUE_MESSAGE(ackReceiver.count >= 3, "Every frame should be acknowledged");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0x1113, ack.received, "The last frame should be acknowledged as received");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0x1113, ack.shown, "The last frame should be acknowledged as shown");
+	#if defined(FLOW_CONTROL_XONXOFF)
+		TEST_ASSERT_EQUAL_MESSAGE(flowControl.isStopped(), SerialPort.isXoff(), "Only the flow control should stop the host");
+	#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////// UNIT TEST ROUTINES //////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+void setup()
+{
+	hostUseVirtualClock(1000000000ULL);
+	flowControl.init();
+
+	UNITY_BEGIN();
+	RUN_TEST(FlowControlTest_ZeroLossUnderOverrun);
+	RUN_TEST(FlowControlTest_OverrunWithoutFlowControl);
+	RUN_TEST(FlowControlTest_SpaceReleasedDuringBatch);
+	RUN_TEST(FlowControlTest_OverrunCountedOnce);
+	RUN_TEST(FlowControlTest_LossAbandonsFrame);
+	RUN_TEST(FlowControlTest_BinaryRecords);
+	RUN_TEST(FlowControlTest_SequencedFrames);
+	UNITY_END();
+}
+
+void loop()
+{
+}
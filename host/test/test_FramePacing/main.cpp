@@ -0,0 +1,226 @@
+/* main.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#define NEOPIXEL_RGB
+
+#include "hosttest.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+//////////////////////////// FRAME PACING (JITTER BUFFER) TEST ////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+#define TEST_LEDS_NUMBER 100
+// 60 FPS of the host
+#define HOST_INTERVAL 16667
+
+/**
+ * @brief Create the frame without the presentation time, all LEDs have the same color
+ *
+ * @param red
+ * @return std::vector<uint8_t>
+ */
+std::vector<uint8_t> createFrame(uint8_t red)
+{
+	std::vector<uint8_t> rgb(TEST_LEDS_NUMBER * 3, 0);
+	std::vector<uint8_t> frame(AwaEncoder::getFrameSize(TEST_LEDS_NUMBER, false));
+
+	for (int i = 0; i < TEST_LEDS_NUMBER; i++)
+		rgb[i * 3] = red;
+
+	AwaEncoder::encodeFrame(frame.data(), frame.size(), rgb.data(), TEST_LEDS_NUMBER);
+	return frame;
+}
+
+/**
+ * @brief The host renders at 60 FPS, the adapter delivers two frames at once every other interval
+ *
+ * @param pairs
+ * @param color the color of the first frame, increased for every next one
+ */
+void sendBursts(int pairs, uint8_t& color)
+{
+	for (int i = 0; i < pairs; i++)
+	{
+		std::vector<uint8_t> burst = createFrame(color++);
+		std::vector<uint8_t> second = createFrame(color++);
+
+		burst.insert(burst.end(), second.begin(), second.end());
+		receive(burst);
+		runFor(HOST_INTERVAL * 2 * 1000ULL);
+	}
+}
+
+/**
+ * @brief Get the largest deviation of the intervals between the shown frames from the host interval
+ *
+ * @param first the first shown frame to check
+ * @return int32_t us
+ */
+int32_t getMaxDeviation(size_t first)
+{
+	int32_t deviation = 0;
+
+	for (size_t i = first + 1; i < shownFrames.size(); i++)
+		deviation = std::max(deviation, abs((int32_t)(shownFrames[i].time - shownFrames[i - 1].time) - HOST_INTERVAL));
+
+	return deviation;
+}
+
+/**
+ * @brief Without the pacing the bursts reach the LED strip as they came
+ *
+ */
+void FramePacingTest_BurstsWithoutPacing()
+{
+	uint8_t color = 0;
+
+	sendCommand(0x76);
+	shownFrames.clear();
+	sendBursts(30, color);
+
+	TEST_ASSERT_EQUAL_INT_MESSAGE(60, shownFrames.size(), "Every frame should be shown");
+	TEST_ASSERT_TRUE_MESSAGE(getMaxDeviation(0) > 8000, "The frames should be shown in bursts without the pacing");
+}
+
+/**
+ * @brief The paced frames are shown at the steady rate and in order
+ *
+ */
+void FramePacingTest_BurstsPaced()
+{
+	uint8_t color = 0;
+
+	sendCommand(0x75);
+	shownFrames.clear();
+	sendBursts(60, color);
+	runFor(100000000);
+
+	TEST_ASSERT_EQUAL_INT_MESSAGE(120, shownFrames.size(), "Every frame should be shown");
+	for (size_t i = 0; i < shownFrames.size(); i++)
+		TEST_ASSERT_EQUAL_INT_MESSAGE(i, shownFrames[i].red, "The frames should be shown in order");
+
+	TEST_ASSERT_TRUE_MESSAGE(abs(framePacer.getInterval() - HOST_INTERVAL) < 200, "Incorrect estimate of the host frame interval");
+	TEST_ASSERT_TRUE_MESSAGE(getMaxDeviation(20) < 500, "The paced frames should be shown at the steady rate");
+	TEST_ASSERT_TRUE_MESSAGE(framePacer.getDepth() <= 2, "The target depth should stay low for the regular bursts");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, errorStatistics.getTotal(ErrorType::QUEUE_FULL), "No frame should be dropped");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, errorStatistics.getTotal(ErrorType::EXPIRED), "No frame should expire");
+}
+
+/**
+ * @brief The frame that came after its turn is shown at once and the target depth goes up
+ *
+ */
+void FramePacingTest_UnderrunRaisesDepth()
+{
+	uint8_t color = 0;
+	uint32_t underruns = framePacer.getUnderruns();
+	int depth = framePacer.getDepth();
+
+	for (int i = 0; i < 30; i++)
+	{
+		receive(createFrame(color++));
+		runFor(HOST_INTERVAL * 1000ULL);
+	}
+
+	// the host stalls for longer than the jitter buffer covers
+	runFor(HOST_INTERVAL * (depth * 1000ULL + 500));
+	shownFrames.clear();
+	receive(createFrame(color++));
+
+	TEST_ASSERT_EQUAL_INT_MESSAGE(underruns + 1, framePacer.getUnderruns(), "The underrun should be counted");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(std::min(depth + 1, FRAME_PACING_MAX_DEPTH), framePacer.getDepth(), "The target depth should go up");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, shownFrames.size(), "The late frame should be shown at once");
+}
+
+/**
+ * @brief The stream paused for a long time starts again without the underrun
+ *
+ */
+void FramePacingTest_PauseRestarts()
+{
+	uint32_t underruns = framePacer.getUnderruns();
+	unsigned long start;
+
+	runFor(1000000000ULL);
+	shownFrames.clear();
+	start = micros();
+	receive(createFrame(200));
+	runFor(100000000);
+
+	TEST_ASSERT_EQUAL_INT_MESSAGE(underruns, framePacer.getUnderruns(), "The pause shouldn't be an underrun");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, shownFrames.size(), "The frame should be shown");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(start + framePacer.getDepth() * framePacer.getInterval(), shownFrames[0].time,
+									"The frame should wait for the target delay");
+}
+
+/**
+ * @brief Disabling the pacing drops the queued frames and the next ones are shown right away
+ *
+ */
+void FramePacingTest_Disable()
+{
+	uint8_t color = 0;
+
+	sendBursts(10, color);
+	receive(createFrame(100));
+	TEST_ASSERT_TRUE_MESSAGE(frameQueue.getCount() > 0, "The frame should wait in the queue");
+
+	sendCommand(0x76);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, frameQueue.getCount(), "The queue should be empty");
+	TEST_ASSERT_TRUE_MESSAGE(!framePacer.isEnabled(), "The pacing should be disabled");
+
+	runFor(50000000);
+	shownFrames.clear();
+	receive(createFrame(101));
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, shownFrames.size(), "The frame should be shown right away");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(101, shownFrames[0].red, "Incorrect color of the shown frame");
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////// UNIT TEST ROUTINES //////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+void setup()
+{
+	hostTestBegin();
+
+	UNITY_BEGIN();
+	RUN_TEST(FramePacingTest_BurstsWithoutPacing);
+	RUN_TEST(FramePacingTest_BurstsPaced);
+	RUN_TEST(FramePacingTest_UnderrunRaisesDepth);
+	RUN_TEST(FramePacingTest_PauseRestarts);
+	RUN_TEST(FramePacingTest_Disable);
+	UNITY_END();
+}
+
+void loop()
+{
+}
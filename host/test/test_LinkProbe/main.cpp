@@ -0,0 +1,151 @@
+/* main.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#define NEOPIXEL_RGB
+
+#include "hosttest.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////// ROUND-TRIP LATENCY PROBE TEST ///////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Create the data with the ping command between the filler bytes
+ *
+ * @param before
+ * @param after
+ * @return std::vector<uint8_t>
+ */
+std::vector<uint8_t> createPing(size_t before, size_t after)
+{
+	std::vector<uint8_t> data(before + AwaEncoder::COMMAND_SIZE + after, 0);
+
+	AwaEncoder::encodeCommand(&data[before], AwaEncoder::COMMAND_SIZE, 0x85);
+	return data;
+}
+
+/**
+ * @brief Run the processing task and get the answer to the ping
+ *
+ * @param record
+ * @return int number of the answers
+ */
+int getReply(PingRecord& record)
+{
+	AwaRecordReceiver receiver(PING_RECORD_TYPE);
+
+	processData();
+	txQueue.flush(receiver);
+	record = receiver.getLast<PingRecord>();
+	return receiver.count;
+}
+
+/**
+ * @brief The answer carries the time the command was read, the time it was decoded and the data behind it
+ *
+ */
+void LinkProbeTest_Reply()
+{
+	PingRecord record;
+	unsigned long received = readSerial(createPing(0, 100), 0);
+
+	hostAdvanceClock(5000000);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, getReply(record), "The ping should be answered");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(received, record.receiveTime, "Incorrect receive time");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(received + 5000, record.replyTime, "Incorrect reply time");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(100, record.ringOccupancy, "Incorrect data buffer occupancy");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, record.txQueued, "The output queue should be empty");
+}
+
+/**
+ * @brief The receive time belongs to the read that brought the command, not to the newer ones
+ *
+ */
+void LinkProbeTest_OlderRead()
+{
+	PingRecord record;
+	unsigned long received = readSerial(createPing(100, 150), 2000);
+
+	hostAdvanceClock(3000000);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, getReply(record), "The ping should be answered");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(received, record.receiveTime, "The receive time should be the one of the first read");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(received + 7000, record.replyTime, "Incorrect reply time");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(150, record.ringOccupancy, "Incorrect data buffer occupancy");
+}
+
+/**
+ * @brief The command in the newest of many reads gets its time, the older reads don't match
+ *
+ */
+void LinkProbeTest_ManyReads()
+{
+	PingRecord record;
+	unsigned long received = readSerial(createPing(HOST_TEST_CHUNK * (LINK_PROBE_CHUNKS + 2), 0), 1000);
+
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, getReply(record), "The ping should be answered");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(received + 1000 * (LINK_PROBE_CHUNKS + 2), record.receiveTime,
+									"The receive time should be the one of the last read");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, record.ringOccupancy, "Incorrect data buffer occupancy");
+}
+
+/**
+ * @brief The answer reports the output waiting ahead of it
+ *
+ */
+void LinkProbeTest_OutputQueue()
+{
+	PingRecord record;
+
+	txQueue.print("queued");
+	readSerial(createPing(0, 0));
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, getReply(record), "The ping should be answered");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(6, record.txQueued, "Incorrect size of the output ahead of the answer");
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////// UNIT TEST ROUTINES //////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+void setup()
+{
+	hostTestBegin();
+
+	UNITY_BEGIN();
+	RUN_TEST(LinkProbeTest_Reply);
+	RUN_TEST(LinkProbeTest_OlderRead);
+	RUN_TEST(LinkProbeTest_ManyReads);
+	RUN_TEST(LinkProbeTest_OutputQueue);
+	UNITY_END();
+}
+
+void loop()
+{
+}
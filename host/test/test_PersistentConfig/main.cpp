@@ -0,0 +1,158 @@
+/* main.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#define NEOPIXEL_RGBW
+#define PERSISTENT_LED_CONFIG
+
+#include "hosttest.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////// PERSISTENT LED CONFIGURATION TEST ///////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Receive the frame with the RGBW calibration (protocol v2), the processing task saves the configuration
+ *
+ * @param leds
+ */
+void receiveFrame(int leds)
+{
+	receive(createAwaFrame(leds, true, leds));
+	runFor(20000000);
+}
+
+/**
+ * @brief The firmware after the reboot: a new object reads the configuration from the flash
+ *
+ * @param leds expected LED count
+ */
+void checkRestored(int leds)
+{
+	decltype(persistentConfig) rebooted;
+
+	TEST_ASSERT_TRUE_MESSAGE(rebooted.load(), "The configuration should be restored");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(leds, rebooted.getLedsNumber(), "Incorrect restored LED count");
+	TEST_ASSERT_TRUE_MESSAGE(rebooted.hasCalibration(), "The calibration should be restored");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0xff, rebooted.getGain(), "Incorrect restored gain");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0xa0, rebooted.getRed(), "Incorrect restored red");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0xa0, rebooted.getGreen(), "Incorrect restored green");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0xa0, rebooted.getBlue(), "Incorrect restored blue");
+
+	// the host sends the same configuration again after the reboot: nothing to write
+	uint32_t writes = Preferences::getWriteCount();
+
+	rebooted.setLedsNumber(leds);
+	rebooted.setCalibration(0xff, 0xa0, 0xa0, 0xa0);
+	rebooted.update(millis() + 3600000);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(writes, Preferences::getWriteCount(), "The unchanged configuration should not be written");
+}
+
+/**
+ * @brief Nothing is stored before the first save
+ *
+ */
+void PersistentConfigTest_EmptyFlash()
+{
+	decltype(persistentConfig) rebooted;
+
+	TEST_ASSERT_TRUE_MESSAGE(!rebooted.load(), "There should be no configuration");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, rebooted.getLedsNumber(), "Incorrect LED count");
+}
+
+/**
+ * @brief The configuration is written when it's stable for SAVE_DELAY and restored after the reboot
+ *
+ */
+void PersistentConfigTest_SaveRebootRestore()
+{
+	receiveFrame(150);
+	runFor(5000000000ULL);
+	receiveFrame(150);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, Preferences::getWriteCount(), "The configuration should wait to be stable");
+
+	runFor(6000000000ULL);
+	receiveFrame(150);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, Preferences::getWriteCount(), "The stable configuration should be written");
+
+	// the same frames don't write the flash again
+	runFor(70000000000ULL);
+	receiveFrame(150);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, Preferences::getWriteCount(), "The unchanged configuration should not be written");
+
+	checkRestored(150);
+}
+
+/**
+ * @brief The changed configuration is written at most once per SAVE_PERIOD
+ *
+ */
+void PersistentConfigTest_SavePeriod()
+{
+	uint32_t writes = Preferences::getWriteCount();
+
+	receiveFrame(200);
+	runFor(11000000000ULL);
+	receiveFrame(200);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(writes + 1, Preferences::getWriteCount(), "The new configuration should be written");
+
+	receiveFrame(250);
+	runFor(11000000000ULL);
+	receiveFrame(250);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(writes + 1, Preferences::getWriteCount(), "The write limit should delay the save");
+	checkRestored(200);
+
+	runFor(50000000000ULL);
+	receiveFrame(250);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(writes + 2, Preferences::getWriteCount(), "The configuration should be written after the period");
+	checkRestored(250);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////// UNIT TEST ROUTINES //////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+void setup()
+{
+	hostTestBegin();
+
+	// like the firmware at boot
+	persistentConfig.load();
+
+	UNITY_BEGIN();
+	RUN_TEST(PersistentConfigTest_EmptyFlash);
+	RUN_TEST(PersistentConfigTest_SaveRebootRestore);
+	RUN_TEST(PersistentConfigTest_SavePeriod);
+	UNITY_END();
+}
+
+void loop()
+{
+}
@@ -0,0 +1,192 @@
+/* main.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#define NEOPIXEL_RGB
+#define PREALLOCATE_LED_STRIPS
+#define PREALLOCATE_MAX_LEDS 200
+#define SECOND_SEGMENT_START_INDEX 100
+#define SECOND_SEGMENT_DATA_PIN 4
+#define SECOND_SEGMENT_REVERSED
+
+#include "hosttest.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+/////////////////////////// PREALLOCATED LED STRIPS TEST //////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief The color of the logical LED: every LED is different and none is black
+ *
+ * @param index
+ * @return RgbColor
+ */
+RgbColor ledColor(int index)
+{
+	return RgbColor(index & 0xff, (index >> 8) + 1, 0x5a);
+}
+
+/**
+ * @brief Receive the frame with ledColor() colors and let it be shown
+ *
+ * @param leds
+ */
+void receiveFrame(int leds)
+{
+	std::vector<uint8_t> frame(AwaEncoder::getFrameSize(leds, false));
+	uint8_t* colors = frame.data() + AwaEncoder::HEADER_SIZE;
+
+	for (int i = 0; i < leds; i++)
+	{
+		RgbColor color = ledColor(i);
+
+		colors[i * 3] = color.R;
+		colors[i * 3 + 1] = color.G;
+		colors[i * 3 + 2] = color.B;
+	}
+
+	AwaEncoder::encodeFrame(frame.data(), frame.size(), colors, leds);
+	receive(frame);
+	runFor(20000000);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(leds, base.getLedsNumber(), "Incorrect number of LEDs");
+}
+
+/**
+ * @brief Check the LED strip pixels against the logical LEDs (reversed second segment), the rest must be black
+ *
+ * @param leds
+ */
+void checkPixels(int leds)
+{
+	LED_DRIVER* strip1 = base.getLedStrip1();
+	LED_DRIVER2* strip2 = base.getLedStrip2();
+
+	for (int i = 0; i < strip1->PixelCount(); i++)
+	{
+		RgbColor expected = (i < leds) ? ledColor(i) : RgbColor();
+		TEST_ASSERT_TRUE_MESSAGE(strip1->GetPixelColor(i) == expected, "Incorrect pixel of the first segment");
+	}
+
+	// the last LED is the first one of the reversed segment
+	for (int i = 0; i < strip2->PixelCount(); i++)
+	{
+		int logical = leds - i - 1;
+		RgbColor expected = (logical >= SECOND_SEGMENT_START_INDEX) ? ledColor(logical) : RgbColor();
+		TEST_ASSERT_TRUE_MESSAGE(strip2->GetPixelColor(i) == expected, "Incorrect pixel of the reversed second segment");
+	}
+}
+
+/**
+ * @brief The strips are reserved for PREALLOCATE_MAX_LEDS (not MAX_LEDS): it's the length sent on every refresh
+ *
+ */
+void PreallocationTest_ReservedLength()
+{
+	TEST_ASSERT_EQUAL_INT_MESSAGE(SECOND_SEGMENT_START_INDEX, base.getLedStrip1()->PixelCount(), "Incorrect first segment length");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(PREALLOCATE_MAX_LEDS - SECOND_SEGMENT_START_INDEX, base.getLedStrip2()->PixelCount(), "Incorrect second segment length");
+
+	// 100 * 24 bits * 1.25us + 300us reset
+	TEST_ASSERT_EQUAL_INT_MESSAGE(3300000, base.getLedStrip2()->getBusNanos(), "Incorrect second segment transfer time");
+}
+
+/**
+ * @brief The frame shorter than the reservation doesn't allocate, the reversed segment starts at its last LED
+ *
+ */
+void PreallocationTest_ReversedSegment()
+{
+	LED_DRIVER* strip1 = base.getLedStrip1();
+	LED_DRIVER2* strip2 = base.getLedStrip2();
+
+	receiveFrame(150);
+	TEST_ASSERT_TRUE_MESSAGE(strip1 == base.getLedStrip1() && strip2 == base.getLedStrip2(), "The strips should not be recreated");
+	checkPixels(150);
+
+	receiveFrame(PREALLOCATE_MAX_LEDS);
+	checkPixels(PREALLOCATE_MAX_LEDS);
+}
+
+/**
+ * @brief The LEDs not used anymore are blanked when the LED count shrinks
+ *
+ */
+void PreallocationTest_ShrinkBlanksLeds()
+{
+	LED_DRIVER* strip1 = base.getLedStrip1();
+	LED_DRIVER2* strip2 = base.getLedStrip2();
+
+	receiveFrame(PREALLOCATE_MAX_LEDS);
+	receiveFrame(120);
+	checkPixels(120);
+
+	receiveFrame(60);
+	checkPixels(60);
+
+	TEST_ASSERT_TRUE_MESSAGE(strip1 == base.getLedStrip1() && strip2 == base.getLedStrip2(), "The strips should not be recreated");
+}
+
+/**
+ * @brief More LEDs than reserved: the strips grow once and keep the new length
+ *
+ */
+void PreallocationTest_GrowBeyondReservation()
+{
+	receiveFrame(250);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(150, base.getLedStrip2()->PixelCount(), "The second segment should grow");
+	checkPixels(250);
+
+	LED_DRIVER2* strip2 = base.getLedStrip2();
+
+	receiveFrame(150);
+	TEST_ASSERT_TRUE_MESSAGE(strip2 == base.getLedStrip2(), "The strips should not be recreated");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(150, base.getLedStrip2()->PixelCount(), "The second segment should keep its length");
+	checkPixels(150);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////// UNIT TEST ROUTINES //////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+void setup()
+{
+	hostTestBegin();
+	base.reserveLedStrips();
+
+	UNITY_BEGIN();
+	RUN_TEST(PreallocationTest_ReservedLength);
+	RUN_TEST(PreallocationTest_ReversedSegment);
+	RUN_TEST(PreallocationTest_ShrinkBlanksLeds);
+	RUN_TEST(PreallocationTest_GrowBeyondReservation);
+	UNITY_END();
+}
+
+void loop()
+{
+}
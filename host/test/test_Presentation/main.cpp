@@ -0,0 +1,265 @@
+/* main.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#define NEOPIXEL_RGB
+
+#include "hosttest.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+////////////////////// PRESENTATION TIME AND CLOCK SYNC TEST //////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+#define TEST_LEDS_NUMBER 300
+
+/**
+ * @brief Create the frame with the presentation time, all LEDs have the same color
+ *
+ * @param sequence
+ * @param presentationTime
+ * @param red
+ * @param green
+ * @param blue
+ * @param leds
+ * @return std::vector<uint8_t>
+ */
+std::vector<uint8_t> createTimedFrame(uint16_t sequence, uint32_t presentationTime, uint8_t red, uint8_t green, uint8_t blue,
+										int leds = TEST_LEDS_NUMBER)
+{
+	std::vector<uint8_t> rgb(leds * 3);
+	std::vector<uint8_t> frame(AwaEncoder::getFrameSize(leds, false, true, true));
+
+	for (int i = 0; i < leds; i++)
+	{
+		rgb[i * 3] = red;
+		rgb[i * 3 + 1] = green;
+		rgb[i * 3 + 2] = blue;
+	}
+
+	AwaEncoder::encodeTimedFrame(frame.data(), frame.size(), rgb.data(), leds, sequence, presentationTime);
+	return frame;
+}
+
+/**
+ * @brief The frame is held until its presentation time and shown exactly then
+ *
+ */
+void PresentationTest_ShownAtTime()
+{
+	unsigned long presentAt = micros() + 30000;
+
+	statistics.update(millis());
+	shownFrames.clear();
+	receive(createTimedFrame(1, presentAt, 10, 20, 30));
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, shownFrames.size(), "The frame should wait for its time");
+
+	runFor(29000000);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, shownFrames.size(), "The frame shouldn't be shown early");
+
+	runFor(2000000);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, shownFrames.size(), "The frame should be shown");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(presentAt, shownFrames[0].time, "The frame should be shown at its presentation time");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(10, shownFrames[0].red, "Incorrect color of the shown frame");
+}
+
+/**
+ * @brief The frames received back to back are queued with their own pixels and shown in order at their time
+ *
+ */
+void PresentationTest_QueuedFramesKeepPixels()
+{
+	unsigned long start = micros();
+	std::vector<uint8_t> stream;
+
+	shownFrames.clear();
+	for (int i = 0; i < 3; i++)
+	{
+		std::vector<uint8_t> frame = createTimedFrame(2 + i, start + 20000 * (i + 1), 50 * (i + 1), 0, 0);
+		stream.insert(stream.end(), frame.begin(), frame.end());
+	}
+	receive(stream);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(3, frameQueue.getCount(), "The frames should be queued");
+
+	runFor(100000000);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(3, shownFrames.size(), "Every frame should be shown");
+	for (int i = 0; i < 3; i++)
+	{
+		TEST_ASSERT_EQUAL_INT_MESSAGE(start + 20000 * (i + 1), shownFrames[i].time, "The frame should be shown at its presentation time");
+		TEST_ASSERT_EQUAL_INT_MESSAGE(50 * (i + 1), shownFrames[i].red, "The frame should keep its pixels in the queue");
+	}
+}
+
+/**
+ * @brief The queued frame shown in the middle of the next frame doesn't break the decoding of it
+ *
+ */
+void PresentationTest_ShowWhileDecoding()
+{
+	unsigned long start = micros();
+	std::vector<uint8_t> next = createTimedFrame(5, start + 60000, 0, 0, 99);
+	size_t half = next.size() / 2;
+
+	shownFrames.clear();
+	receive(createTimedFrame(6, start + 20000, 0, 77, 0));
+	receive(std::vector<uint8_t>(next.begin(), next.begin() + half));
+
+	runFor(30000000);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, shownFrames.size(), "The first frame should be shown");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(77, shownFrames[0].green, "Incorrect color of the first frame");
+
+	uint32_t good = statistics.lifetime.goodFrames;
+
+	receive(std::vector<uint8_t>(next.begin() + half, next.end()));
+	TEST_ASSERT_EQUAL_INT_MESSAGE(good + 1, statistics.lifetime.goodFrames, "The second frame should be received");
+
+	runFor(40000000);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(2, shownFrames.size(), "The second frame should be shown");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(start + 60000, shownFrames[1].time, "The second frame should be shown at its presentation time");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(99, shownFrames[1].blue, "The second frame should keep all of its pixels");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, shownFrames[1].green, "The second frame shouldn't have the pixels of the first one");
+}
+
+/**
+ * @brief The frame received after its presentation time or not shown in time is dropped and counted
+ *
+ */
+void PresentationTest_ExpiredFrames()
+{
+	uint32_t expired = errorStatistics.getTotal(ErrorType::EXPIRED);
+
+	shownFrames.clear();
+	receive(createTimedFrame(7, micros() - 10000, 1, 1, 1));
+	TEST_ASSERT_EQUAL_INT_MESSAGE(expired + 1, errorStatistics.getTotal(ErrorType::EXPIRED), "The late frame should be dropped");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, frameQueue.getCount(), "The late frame shouldn't be queued");
+
+	// the processing task is blocked for 30ms, the frame due after 10ms comes too late
+	receive(createTimedFrame(8, micros() + 10000, 2, 2, 2));
+	hostAdvanceClock(30000000);
+	xSemaphoreTake(wakeup, 0);
+	processData();
+	TEST_ASSERT_EQUAL_INT_MESSAGE(expired + 2, errorStatistics.getTotal(ErrorType::EXPIRED), "The frame not shown in time should be dropped");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, shownFrames.size(), "The expired frames shouldn't be shown");
+}
+
+/**
+ * @brief The queued frames are acknowledged when they are shown
+ *
+ */
+void PresentationTest_Acknowledgement()
+{
+	AwaRecordReceiver receiver(ACK_RECORD_TYPE);
+	unsigned long presentAt = micros() + 20000;
+	AckRecord ack;
+
+	txQueue.flush(receiver);
+	receive(createTimedFrame(100, presentAt, 3, 3, 3));
+	txQueue.flush(receiver);
+	ack = receiver.getLast<AckRecord>();
+	TEST_ASSERT_EQUAL_INT_MESSAGE(100, ack.received, "The frame should be acknowledged as received");
+	TEST_ASSERT_TRUE_MESSAGE(ack.shown != 100, "The queued frame shouldn't be acknowledged as shown");
+
+	runFor(30000000);
+	txQueue.flush(receiver);
+	ack = receiver.getLast<AckRecord>();
+	TEST_ASSERT_EQUAL_INT_MESSAGE(100, ack.shown, "The frame should be acknowledged as shown");
+}
+
+/**
+ * @brief The queued frames dropped for the new LED count or frame size are acknowledged, the host doesn't wait for them
+ *
+ */
+void PresentationTest_DroppedFramesAcknowledged()
+{
+	AwaRecordReceiver receiver(ACK_RECORD_TYPE);
+	unsigned long presentAt = micros() + 500000;
+	AckRecord ack;
+
+	txQueue.flush(receiver);
+	receive(createTimedFrame(200, presentAt, 1, 1, 1));
+	receive(createTimedFrame(201, presentAt + 20000, 2, 2, 2));
+	TEST_ASSERT_EQUAL_INT_MESSAGE(2, frameQueue.getCount(), "The frames should be queued");
+
+	// the new LED count drops both
+	receive(createTimedFrame(202, presentAt + 40000, 3, 3, 3, TEST_LEDS_NUMBER + 10));
+	txQueue.flush(receiver);
+	ack = receiver.getLast<AckRecord>();
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, frameQueue.getCount(), "Only the new frame should be queued");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(202, ack.received, "The new frame should be acknowledged as received");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(201, ack.shown, "The dropped frames should be acknowledged");
+
+	// the storage for another frame size drops the queued frame too
+	frameQueue.reserve(frameQueue.getFrameSize() * 2);
+	frameAck.update(base.hasLateFrameToRender(), 0);
+	txQueue.flush(receiver);
+	ack = receiver.getLast<AckRecord>();
+	TEST_ASSERT_TRUE_MESSAGE(frameQueue.isEmpty(), "The queued frame should be dropped");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(202, ack.shown, "The dropped frame should be acknowledged");
+}
+
+/**
+ * @brief The clock command returns the device time
+ *
+ */
+void PresentationTest_ClockSync()
+{
+	AwaRecordReceiver receiver(CLOCK_RECORD_TYPE);
+	ClockRecord clock;
+
+	txQueue.flush(receiver);
+	sendCommand(0x65);
+	txQueue.flush(receiver);
+
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, receiver.count, "The clock record should be sent");
+	clock = receiver.getLast<ClockRecord>();
+	TEST_ASSERT_EQUAL_INT_MESSAGE((uint32_t)micros(), clock.deviceTime, "The clock record should carry the device time");
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////// UNIT TEST ROUTINES //////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+void setup()
+{
+	hostTestBegin();
+
+	UNITY_BEGIN();
+	RUN_TEST(PresentationTest_ShownAtTime);
+	RUN_TEST(PresentationTest_QueuedFramesKeepPixels);
+	RUN_TEST(PresentationTest_ShowWhileDecoding);
+	RUN_TEST(PresentationTest_ExpiredFrames);
+	RUN_TEST(PresentationTest_Acknowledgement);
+	RUN_TEST(PresentationTest_DroppedFramesAcknowledged);
+	RUN_TEST(PresentationTest_ClockSync);
+	UNITY_END();
+}
+
+void loop()
+{
+}
@@ -0,0 +1,199 @@
+/* main.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#define NEOPIXEL_RGBW
+#define ENABLE_PROFILING
+
+#include <string>
+#include "hosttest.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////// PROFILER TABLE TEST ///////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+#define TEST_LEDS_NUMBER 100
+#define TEST_FRAMES 5
+
+// the LED strip transfer is started in Show(), let it take 1ms of the CPU time (240000 cycles)
+#define SHOW_NANOS 1000000ULL
+
+/**
+ * @brief The text output of the device
+ *
+ */
+class TextReceiver
+{
+	public:
+		std::string text;
+
+		int availableForWrite()
+		{
+			return 1024;
+		}
+
+		size_t write(const uint8_t* data, size_t size)
+		{
+			text.append((const char*)data, size);
+			return size;
+		}
+};
+
+/**
+ * @brief Row of the profiler table
+ *
+ */
+struct ProfileRow
+{
+	unsigned int calls = 0;
+	unsigned long long cycles = 0;
+	unsigned int average = 0;
+	bool found = false;
+};
+
+/**
+ * @brief Find the row of the stage in the table
+ *
+ * @param table
+ * @param name
+ * @return ProfileRow
+ */
+ProfileRow findRow(const std::string& table, const char* name)
+{
+	ProfileRow row;
+	std::string prefix = std::string("Profile ") + name + ": ";
+	size_t position = table.find(prefix);
+
+	if (position != std::string::npos)
+		row.found = sscanf(table.c_str() + position + prefix.size(), "calls: %u, cycles: %llu, avg: %u",
+							&row.calls, &row.cycles, &row.average) == 3;
+	return row;
+}
+
+/**
+ * @brief Send the 0x45 command and take the printed table
+ *
+ * @return std::string
+ */
+std::string requestTable()
+{
+	TextReceiver receiver;
+
+	txQueue.flush(receiver);
+	receiver.text.clear();
+	sendCommand(0x45);
+	txQueue.flush(receiver);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, receiver.text.size(), "The table should wait for the serial read stage");
+
+	// the serial task hands over its stage and wakes up the processing task
+	TEST_ASSERT_TRUE_MESSAGE(serialTaskHandler(), "The processing task should be woken up");
+	processData();
+	txQueue.flush(receiver);
+	return receiver.text;
+}
+
+void onProfiledShow(const void*, const uint8_t*, size_t, int)
+{
+	hostAdvanceClock(SHOW_NANOS);
+}
+
+/**
+ * @brief The table has every stage, the calls of the decoded frames and the cycles of the Show() calls
+ *
+ */
+void ProfilerTest_Table()
+{
+	int frameSize = AwaEncoder::getFrameSize(TEST_LEDS_NUMBER, false);
+	int chunks = (frameSize + HOST_TEST_CHUNK - 1) / HOST_TEST_CHUNK;
+
+	// start with the empty table
+	requestTable();
+
+	hostShowHook = onProfiledShow;
+	for (int i = 0; i < TEST_FRAMES; i++)
+	{
+		receive(createAwaFrame(TEST_LEDS_NUMBER, false, i));
+		runFor(20000000);
+	}
+	hostShowHook = onShow;
+
+	std::string table = requestTable();
+	const char* names[] = { "serial read", "decode", "fletcher", "rgb2rgbw", "set pixel", "show" };
+
+	for (const char* name : names)
+		TEST_ASSERT_TRUE_MESSAGE(findRow(table, name).found, name);
+
+	// the command was read too
+	TEST_ASSERT_EQUAL_INT_MESSAGE(TEST_FRAMES * chunks + 1, findRow(table, "serial read").calls, "Incorrect serial read calls");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(TEST_FRAMES * TEST_LEDS_NUMBER, findRow(table, "set pixel").calls, "Incorrect set pixel calls");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(TEST_FRAMES * TEST_LEDS_NUMBER, findRow(table, "rgb2rgbw").calls, "Incorrect rgb2rgbw calls");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(TEST_FRAMES * TEST_LEDS_NUMBER * 3, findRow(table, "fletcher").calls, "Incorrect fletcher calls");
+
+	ProfileRow show = findRow(table, "show");
+
+	TEST_ASSERT_EQUAL_INT_MESSAGE(TEST_FRAMES, show.calls, "Incorrect show calls");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(TEST_FRAMES * SHOW_NANOS * 240 / 1000, show.cycles, "Incorrect show cycles");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(SHOW_NANOS * 240 / 1000, show.average, "Incorrect show average");
+
+	// the decode stage includes the nested ones
+	TEST_ASSERT_TRUE_MESSAGE(findRow(table, "decode").cycles >= show.cycles, "The decode stage should include the show");
+}
+
+/**
+ * @brief The table is reset after it's printed
+ *
+ */
+void ProfilerTest_Reset()
+{
+	requestTable();
+	std::string table = requestTable();
+
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, findRow(table, "set pixel").calls, "The table should be reset");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, findRow(table, "show").calls, "The table should be reset");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, findRow(table, "show").average, "The average of the empty stage should be 0");
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////// UNIT TEST ROUTINES //////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+void setup()
+{
+	hostTestBegin();
+
+	UNITY_BEGIN();
+	RUN_TEST(ProfilerTest_Table);
+	RUN_TEST(ProfilerTest_Reset);
+	UNITY_END();
+}
+
+void loop()
+{
+}
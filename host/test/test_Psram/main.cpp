@@ -0,0 +1,119 @@
+/* main.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#define NEOPIXEL_RGB
+#define USE_PSRAM
+
+#include "hosttest.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////// PSRAM DATA BUFFER TEST //////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+#define TEST_LEDS_NUMBER 300
+
+/**
+ * @brief Start again without the data buffer and with the given memory
+ *
+ * @param psram the module has PSRAM
+ * @param failedCaps the memory types that are full
+ */
+void resetBuffers(bool psram, uint32_t failedCaps)
+{
+	free(base.buffer);
+	base.buffer = nullptr;
+	hostPsramFound = psram;
+	hostFailedHeapCaps = failedCaps;
+}
+
+/**
+ * @brief No memory for the data buffer: initBuffers() reports it
+ *
+ */
+void PsramTest_AllocationFailure()
+{
+	resetBuffers(false, MALLOC_CAP_INTERNAL);
+	TEST_ASSERT_TRUE_MESSAGE(!base.initBuffers(), "The failed allocation should be reported");
+	TEST_ASSERT_TRUE_MESSAGE(base.buffer == nullptr, "There should be no data buffer");
+
+	resetBuffers(true, MALLOC_CAP_INTERNAL | MALLOC_CAP_SPIRAM);
+	TEST_ASSERT_TRUE_MESSAGE(!base.initBuffers(), "The failed allocation should be reported");
+}
+
+/**
+ * @brief The internal RAM is full: the data buffer goes to PSRAM
+ *
+ */
+void PsramTest_FallbackToPsram()
+{
+	resetBuffers(true, MALLOC_CAP_INTERNAL);
+	TEST_ASSERT_TRUE_MESSAGE(base.initBuffers(), "The data buffer should be allocated in PSRAM");
+	TEST_ASSERT_TRUE_MESSAGE(base.buffer != nullptr, "There should be the data buffer");
+}
+
+/**
+ * @brief The data buffer from the internal RAM (PSRAM is full) takes the frames, also across its end
+ *
+ */
+void PsramTest_FramesDecoded()
+{
+	resetBuffers(true, MALLOC_CAP_SPIRAM);
+	TEST_ASSERT_TRUE_MESSAGE(base.initBuffers(), "The data buffer should be allocated in the internal RAM");
+
+	uint32_t good = statistics.lifetime.goodFrames;
+	int frames = MAX_BUFFER / AwaEncoder::getFrameSize(TEST_LEDS_NUMBER, false) * 3;
+
+	for (int i = 0; i < frames; i++)
+	{
+		receive(createAwaFrame(TEST_LEDS_NUMBER, false, i));
+		runFor(20000000);
+	}
+	TEST_ASSERT_EQUAL_INT_MESSAGE(good + frames, statistics.lifetime.goodFrames, "Every frame should be decoded");
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////// UNIT TEST ROUTINES //////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+void setup()
+{
+	hostTestBegin();
+
+	UNITY_BEGIN();
+	RUN_TEST(PsramTest_AllocationFailure);
+	RUN_TEST(PsramTest_FallbackToPsram);
+	RUN_TEST(PsramTest_FramesDecoded);
+	UNITY_END();
+}
+
+void loop()
+{
+}
@@ -0,0 +1,196 @@
+/* main.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#define NEOPIXEL_RGB
+
+#include "hosttest.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////// STRIP TIMING MODEL AND VIRTUAL CLOCK TEST ///////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+#define TEST_LEDS_NUMBER 300
+
+/**
+ * @brief Receive the frame and let the processing task decode it
+ *
+ * @param seed
+ */
+void receiveFrame(uint32_t seed)
+{
+	receive(createAwaFrame(TEST_LEDS_NUMBER, false, seed));
+}
+
+/**
+ * @brief The bus is busy for the physical transfer time of WS2812 and SK6812
+ *
+ */
+void StripTimingTest_BusTime()
+{
+	NeoPixelBus<NeoGrbFeature, NeoEsp32I2s0Ws2812xMethod> ws2812(300, 2);
+	NeoPixelBus<NeoGrbwFeature, NeoEsp32I2s0Sk6812Method> sk6812(300, 2);
+
+	// 300 * 24 bits * 1.25us + 300us reset, 300 * 32 bits * 1.25us + 80us reset
+	TEST_ASSERT_EQUAL_INT_MESSAGE(9300000, ws2812.getBusNanos(), "Incorrect WS2812 transfer time");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(12080000, sk6812.getBusNanos(), "Incorrect SK6812 transfer time");
+
+	ws2812.Show();
+	TEST_ASSERT_EQUAL_MESSAGE(false, ws2812.CanShow(), "The bus should be busy");
+	hostAdvanceClock(9300000 - 1);
+	TEST_ASSERT_EQUAL_MESSAGE(false, ws2812.CanShow(), "The bus should be still busy");
+	hostAdvanceClock(1);
+	TEST_ASSERT_EQUAL_MESSAGE(true, ws2812.CanShow(), "The bus should be free");
+}
+
+/**
+ * @brief Back-to-back Show() calls are serialized: the next one waits until the previous transfer is done
+ *
+ */
+void StripTimingTest_ShowSerialized()
+{
+	NeoPixelBus<NeoGrbFeature, NeoEsp32I2s0Ws2812xMethod> ws2812(300, 2);
+	uint64_t start = hostClockNanos();
+
+	ws2812.Show();
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, hostClockNanos() - start, "Show() on the free bus shouldn't wait");
+
+	ws2812.Show();
+	TEST_ASSERT_EQUAL_INT_MESSAGE(9300000, hostClockNanos() - start, "The second Show() should wait for the first transfer");
+	ws2812.Show();
+	TEST_ASSERT_EQUAL_INT_MESSAGE(2 * 9300000, hostClockNanos() - start, "The third Show() should wait for the second transfer");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(2, ws2812.getBlockedShowCount(), "Both Show() calls should wait");
+
+	// the last transfer keeps the bus for its whole time
+	hostAdvanceClock(9300000 - 1);
+	TEST_ASSERT_EQUAL_MESSAGE(false, ws2812.CanShow(), "The last transfer should take the bus");
+	hostAdvanceClock(1);
+	TEST_ASSERT_EQUAL_MESSAGE(true, ws2812.CanShow(), "The bus should be free");
+}
+
+/**
+ * @brief The frame received while the bus is busy is late: the render timer shows it when the bus is free
+ *
+ */
+void StripTimingTest_LateFrameIsRenderedByTimer()
+{
+	uint32_t seed = 0;
+
+	statistics.update(millis());
+	receiveFrame(seed++);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, statistics.lifetime.showFrames, "The first frame should be shown");
+
+	for (int round = 0; round < 4; round++)
+	{
+		uint32_t shown = statistics.lifetime.showFrames;
+		uint32_t late = statistics.lifetime.lateFrames;
+
+		// the next frame comes 1ms after the previous one was shown, the bus is busy for 9.3ms
+		hostAdvanceClock(1000000);
+		receiveFrame(seed++);
+		TEST_ASSERT_EQUAL_INT_MESSAGE(late + 1, statistics.lifetime.lateFrames, "The frame should be late");
+		TEST_ASSERT_EQUAL_INT_MESSAGE(shown, statistics.lifetime.showFrames, "The frame should wait for the bus");
+
+		wakeups = 0;
+		runFor(20000000, true);
+		TEST_ASSERT_EQUAL_INT_MESSAGE(shown + 1, statistics.lifetime.showFrames, "The late frame should be shown by the timer");
+
+		// the first round learns the bus time, later the timer fires right when the bus is free
+		if (round > 0)
+			TEST_ASSERT_LESS_THAN_MESSAGE(3, wakeups, "The render timer should predict the free bus");
+	}
+}
+
+/**
+ * @brief The frame replaced by the newer one before the bus was free is counted as dropped
+ *
+ */
+void StripTimingTest_LateFrameDrop()
+{
+	uint32_t drops = errorStatistics.getTotal(ErrorType::LATE_DROP);
+
+	runFor(20000000);
+	receiveFrame(100);
+	hostAdvanceClock(1000000);
+	receiveFrame(101);
+	hostAdvanceClock(1000000);
+	receiveFrame(102);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(drops + 1, errorStatistics.getTotal(ErrorType::LATE_DROP), "The waiting frame should be dropped");
+	runFor(20000000);
+}
+
+/**
+ * @brief The statistics period restarts every second while the frames are coming, the decoder recovers after 5s without data
+ *
+ */
+void StripTimingTest_StatisticsPeriod()
+{
+	unsigned long start = millis();
+
+	statistics.update(start);
+	for (int i = 0; i < 90; i++)
+	{
+		receiveFrame(200 + i);
+		runFor(16666666);
+	}
+	TEST_ASSERT_LESS_THAN_MESSAGE(1100, millis() - statistics.getStartTime(), "The statistics period should restart");
+	TEST_ASSERT_TRUE_MESSAGE(statistics.getStartTime() >= start + 1000, "The statistics period should restart after 1s");
+
+	// a half of the frame, then 6 seconds without data
+	std::vector<uint8_t> frame = createAwaFrame(TEST_LEDS_NUMBER, false, 300);
+	uint32_t good = statistics.lifetime.goodFrames;
+
+	frame.resize(frame.size() / 2);
+	receive(frame);
+	runFor(6000000000ULL);
+	receiveFrame(301);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(good + 1, statistics.lifetime.goodFrames, "The decoder should recover after 5s");
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////// UNIT TEST ROUTINES //////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+void setup()
+{
+	hostTestBegin();
+
+	UNITY_BEGIN();
+	RUN_TEST(StripTimingTest_BusTime);
+	RUN_TEST(StripTimingTest_ShowSerialized);
+	RUN_TEST(StripTimingTest_LateFrameIsRenderedByTimer);
+	RUN_TEST(StripTimingTest_LateFrameDrop);
+	RUN_TEST(StripTimingTest_StatisticsPeriod);
+	UNITY_END();
+}
+
+void loop()
+{
+}
@@ -0,0 +1,204 @@
+/* main.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#define NEOPIXEL_RGB
+
+#include "hosttest.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////// TELEMETRY RECORD TEST /////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+#define TEST_LEDS_NUMBER 300
+#define TEST_FRAMES 10
+#define TEST_RESYNC_BYTES 7
+
+/**
+ * @brief The telemetry record as the host decodes it: 26 bytes, little-endian
+ *
+ */
+struct DecodedTelemetry
+{
+	uint32_t timestamp;
+	uint16_t interval;
+	uint16_t goodFrames;
+	uint16_t showFrames;
+	uint16_t lateFrames;
+	uint16_t checksumErrors;
+	uint32_t bytesPerSecond;
+	uint32_t resyncBytes;
+	uint32_t ringHighWater;
+};
+
+uint32_t readLittleEndian(const uint8_t* data, int size)
+{
+	uint32_t value = 0;
+
+	for (int i = size - 1; i >= 0; i--)
+		value = (value << 8) | data[i];
+	return value;
+}
+
+DecodedTelemetry decodeTelemetry(const uint8_t* payload)
+{
+	DecodedTelemetry record;
+
+	record.timestamp = readLittleEndian(payload, 4);
+	record.interval = readLittleEndian(payload + 4, 2);
+	record.goodFrames = readLittleEndian(payload + 6, 2);
+	record.showFrames = readLittleEndian(payload + 8, 2);
+	record.lateFrames = readLittleEndian(payload + 10, 2);
+	record.checksumErrors = readLittleEndian(payload + 12, 2);
+	record.bytesPerSecond = readLittleEndian(payload + 14, 4);
+	record.resyncBytes = readLittleEndian(payload + 18, 4);
+	record.ringHighWater = readLittleEndian(payload + 22, 4);
+	return record;
+}
+
+AwaRecordReceiver receiver(TELEMETRY_RECORD_TYPE);
+
+/**
+ * @brief Let the processing task run (it sends the record when the interval elapsed) and take the output
+ *
+ */
+void updateTelemetry()
+{
+	processData();
+	txQueue.flush(receiver);
+}
+
+/**
+ * @brief The record after 0x2aa2/0x55 has the statistics of the interval in the 26-byte layout
+ *
+ */
+void TelemetryTest_Record()
+{
+	std::vector<uint8_t> stream(TEST_RESYNC_BYTES, 0);
+	uint32_t bytes = 0;
+
+	txQueue.flush(receiver);
+	sendCommand(0x55);
+	unsigned long start = millis();
+
+	// garbage, the frames (one with the checksum error), 20ms apart
+	for (int i = 0; i < TEST_FRAMES; i++)
+	{
+		std::vector<uint8_t> frame = createAwaFrame(TEST_LEDS_NUMBER, false, i);
+
+		if (i == 3)
+			frame[AwaEncoder::HEADER_SIZE + 10] ^= 0x5a;
+		stream.insert(stream.end(), frame.begin(), frame.end());
+		receive(stream);
+		bytes += stream.size();
+		stream.clear();
+		runFor(20000000);
+	}
+
+	hostAdvanceClock((start + TELEMETRY_INTERVAL - 1 - millis()) * 1000000ULL);
+	updateTelemetry();
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, receiver.count, "No record before the interval elapsed");
+
+	hostAdvanceClock(11000000);
+	updateTelemetry();
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, receiver.count, "The record should be sent");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(26, receiver.size, "Incorrect record size");
+
+	DecodedTelemetry record = decodeTelemetry(receiver.last);
+	unsigned long interval = TELEMETRY_INTERVAL + 10;
+
+	TEST_ASSERT_EQUAL_INT_MESSAGE(millis(), record.timestamp, "Incorrect timestamp");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(interval, record.interval, "Incorrect interval");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(TEST_FRAMES - 1, record.goodFrames, "Incorrect good frames");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(TEST_FRAMES - 1, record.showFrames, "Incorrect shown frames");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, record.lateFrames, "Incorrect late frames");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, record.checksumErrors, "Incorrect checksum errors");
+	TEST_ASSERT_EQUAL_INT_MESSAGE((uint64_t)bytes * 1000 / interval, record.bytesPerSecond, "Incorrect data rate");
+	// the decoder leaves the bad frame at its first checksum byte, the other two are skipped too
+	TEST_ASSERT_EQUAL_INT_MESSAGE(TEST_RESYNC_BYTES + 2, record.resyncBytes, "Incorrect resync bytes");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(statistics.lifetime.ringHighWater, record.ringHighWater, "Incorrect ring high water");
+	TEST_ASSERT_TRUE_MESSAGE(record.ringHighWater > 0, "The ring high water should be set");
+}
+
+/**
+ * @brief The next record has only the statistics of its own interval
+ *
+ */
+void TelemetryTest_NextInterval()
+{
+	hostAdvanceClock(TELEMETRY_INTERVAL * 1000000ULL);
+	updateTelemetry();
+	TEST_ASSERT_EQUAL_INT_MESSAGE(2, receiver.count, "The next record should be sent");
+
+	DecodedTelemetry record = decodeTelemetry(receiver.last);
+
+	TEST_ASSERT_EQUAL_INT_MESSAGE(TELEMETRY_INTERVAL, record.interval, "Incorrect interval");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, record.goodFrames, "Incorrect good frames");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, record.checksumErrors, "Incorrect checksum errors");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, record.bytesPerSecond, "Incorrect data rate");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, record.resyncBytes, "Incorrect resync bytes");
+}
+
+/**
+ * @brief No record after 0x2aa2/0x56
+ *
+ */
+void TelemetryTest_Disable()
+{
+	sendCommand(0x56);
+	txQueue.flush(receiver);
+	int count = receiver.count;
+
+	for (int i = 0; i < 4; i++)
+	{
+		hostAdvanceClock(TELEMETRY_INTERVAL * 1000000ULL);
+		updateTelemetry();
+	}
+	TEST_ASSERT_EQUAL_INT_MESSAGE(count, receiver.count, "The telemetry should be disabled");
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////// UNIT TEST ROUTINES //////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+void setup()
+{
+	hostTestBegin();
+
+	UNITY_BEGIN();
+	RUN_TEST(TelemetryTest_Record);
+	RUN_TEST(TelemetryTest_NextInterval);
+	RUN_TEST(TelemetryTest_Disable);
+	UNITY_END();
+}
+
+void loop()
+{
+}
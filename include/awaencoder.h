@@ -0,0 +1,350 @@
+/* awaencoder.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef AWAENCODER_H
+#define AWAENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Reference encoder of the AWA protocol for the tests and the host tools (the firmware only decodes).
+ * Frame: 'A' 'w' type, LED count - 1 (big endian), header CRC (hi ^ lo ^ 0x55), payload, fletcher1, fletcher2, fletcherExt.
+ * Types: 'a' RGB colors, 'A' RGB colors + white channel calibration (gain, red, green, blue), 'm' remap table (16-bit big endian indexes),
+ * 's'/'S' the same as 'a'/'A' with the 16-bit big endian sequence number before the colors (acknowledged by the device),
+ * 'p'/'P' the same as 's'/'S' with the 32-bit big endian presentation time (device micros()) after the sequence number.
+ * Commands reuse the header: 'A' 'w' 'a' 0x2a 0xa2 followed by the command byte instead of the CRC.
+ * All functions work on the caller buffers and never allocate.
+ *
+ */
+class AwaEncoder
+{
+	public:
+		static const size_t HEADER_SIZE = 6;
+		static const size_t SEQUENCE_SIZE = 2;
+		static const size_t PRESENTATION_SIZE = 4;
+		static const size_t CALIBRATION_SIZE = 4;
+		static const size_t TRAILER_SIZE = 3;
+		static const size_t COMMAND_SIZE = 6;
+		static const int PROTOCOL_MAX_LEDS = 65536;
+
+		// bytes per checksum block: the 32-bit sums can't overflow before the modulo
+		static const size_t CHECKSUM_BLOCK = 4096;
+
+		/**
+		 * @brief White channel calibration of the protocol v2 frame
+		 *
+		 */
+		struct Calibration
+		{
+			uint8_t gain;
+			uint8_t red;
+			uint8_t green;
+			uint8_t blue;
+		};
+
+		/**
+		 * @brief Get the size of the color frame
+		 *
+		 * @param leds
+		 * @param calibration protocol v2
+		 * @param sequenced with the sequence number
+		 * @param timed with the sequence number and the presentation time
+		 * @return size_t
+		 */
+		static inline size_t getFrameSize(int leds, bool calibration, bool sequenced = false, bool timed = false)
+		{
+			return HEADER_SIZE + getExtensionSize(sequenced, timed) + (size_t)leds * 3 + ((calibration) ? CALIBRATION_SIZE : 0) + TRAILER_SIZE;
+		}
+
+		/**
+		 * @brief Get the size of the remap table frame
+		 *
+		 * @param leds
+		 * @return size_t
+		 */
+		static inline size_t getRemapFrameSize(int leds)
+		{
+			return HEADER_SIZE + (size_t)leds * 2 + TRAILER_SIZE;
+		}
+
+		/**
+		 * @brief Write the frame header
+		 *
+		 * @param output at least HEADER_SIZE bytes
+		 * @param type 'a', 'A' or 'm'
+		 * @param leds 1-65536
+		 */
+		static inline void writeHeader(uint8_t* output, uint8_t type, int leds)
+		{
+			uint16_t count = (uint16_t)(leds - 1);
+
+			output[0] = 'A';
+			output[1] = 'w';
+			output[2] = type;
+			output[3] = count >> 8;
+			output[4] = count & 0xff;
+			output[5] = output[3] ^ output[4] ^ 0x55;
+		}
+
+		/**
+		 * @brief Compute the checksums of the payload and write the trailer.
+		 * The sums are reduced once per CHECKSUM_BLOCK bytes instead of every byte and the loop is unrolled by 8,
+		 * the result is identical to the per-byte reference (checksumReference).
+		 *
+		 * @param payload
+		 * @param size
+		 * @param trailer TRAILER_SIZE bytes, can directly follow the payload
+		 */
+		static void writeChecksum(const uint8_t* payload, size_t size, uint8_t* trailer)
+		{
+			uint32_t fletcher1 = 0, fletcher2 = 0, fletcherExt = 0;
+			uint8_t position = 0;
+
+			while (size > 0)
+			{
+				size_t block = (size < CHECKSUM_BLOCK) ? size : CHECKSUM_BLOCK;
+				const uint8_t* end = payload + (block & ~(size_t)7);
+
+				size -= block;
+				block &= 7;
+
+				for (; payload < end; payload += 8, position += 8)
+				{
+					uint32_t sum = 0, weighted = 0, ext = 0;
+
+					for (int i = 0; i < 8; i++)
+					{
+						sum += payload[i];
+						weighted += (8 - i) * payload[i];
+						ext += payload[i] ^ (uint8_t)(position + i);
+					}
+
+					fletcher2 += 8 * fletcher1 + weighted;
+					fletcher1 += sum;
+					fletcherExt += ext;
+				}
+
+				for (; block > 0; block--, payload++, position++)
+				{
+					fletcher1 += *payload;
+					fletcher2 += fletcher1;
+					fletcherExt += *payload ^ position;
+				}
+
+				fletcher1 %= 255;
+				fletcher2 %= 255;
+				fletcherExt %= 255;
+			}
+
+			trailer[0] = (uint8_t)fletcher1;
+			trailer[1] = (uint8_t)fletcher2;
+			trailer[2] = (uint8_t)((fletcherExt != 0x41) ? fletcherExt : 0xaa);
+		}
+
+		/**
+		 * @brief Per-byte checksums exactly as the decoder computes them (to verify writeChecksum)
+		 *
+		 * @param payload
+		 * @param size
+		 * @param trailer TRAILER_SIZE bytes
+		 */
+		static void checksumReference(const uint8_t* payload, size_t size, uint8_t* trailer)
+		{
+			uint16_t fletcher1 = 0, fletcher2 = 0, fletcherExt = 0;
+			uint8_t position = 0;
+
+			for (size_t i = 0; i < size; i++)
+			{
+				fletcherExt = (fletcherExt + (payload[i] ^ (position++))) % 255;
+				fletcher1 = (fletcher1 + payload[i]) % 255;
+				fletcher2 = (fletcher2 + fletcher1) % 255;
+			}
+
+			trailer[0] = (uint8_t)fletcher1;
+			trailer[1] = (uint8_t)fletcher2;
+			trailer[2] = (uint8_t)((fletcherExt != 0x41) ? fletcherExt : 0xaa);
+		}
+
+		/**
+		 * @brief Encode the color frame
+		 *
+		 * @param output
+		 * @param capacity size of the output buffer
+		 * @param rgb 3 bytes per LED, can already be in place (output + HEADER_SIZE)
+		 * @param leds 1-65536
+		 * @param calibration white channel calibration (protocol v2) or nullptr (protocol v1)
+		 * @return size_t the frame size, 0 if the LED count is invalid or the buffer is too small
+		 */
+		static size_t encodeFrame(uint8_t* output, size_t capacity, const uint8_t* rgb, int leds, const Calibration* calibration = nullptr)
+		{
+			return encodeColors(output, capacity, rgb, leds, calibration, false, false, 0, 0);
+		}
+
+		/**
+		 * @brief Encode the color frame with the sequence number, the device acknowledges it
+		 *
+		 * @param output
+		 * @param capacity size of the output buffer
+		 * @param rgb 3 bytes per LED, can already be in the buffer (anywhere after output + HEADER_SIZE)
+		 * @param leds 1-65536
+		 * @param sequence
+		 * @param calibration white channel calibration (protocol v2) or nullptr (protocol v1)
+		 * @return size_t the frame size, 0 if the LED count is invalid or the buffer is too small
+		 */
+		static size_t encodeSequencedFrame(uint8_t* output, size_t capacity, const uint8_t* rgb, int leds, uint16_t sequence,
+											const Calibration* calibration = nullptr)
+		{
+			return encodeColors(output, capacity, rgb, leds, calibration, true, false, sequence, 0);
+		}
+
+		/**
+		 * @brief Encode the color frame with the sequence number and the presentation time, the device shows it at that time
+		 *
+		 * @param output
+		 * @param capacity size of the output buffer
+		 * @param rgb 3 bytes per LED, can already be in the buffer (anywhere after output + HEADER_SIZE)
+		 * @param leds 1-65536
+		 * @param sequence
+		 * @param presentationTime micros() of the device
+		 * @param calibration white channel calibration (protocol v2) or nullptr (protocol v1)
+		 * @return size_t the frame size, 0 if the LED count is invalid or the buffer is too small
+		 */
+		static size_t encodeTimedFrame(uint8_t* output, size_t capacity, const uint8_t* rgb, int leds, uint16_t sequence,
+										uint32_t presentationTime, const Calibration* calibration = nullptr)
+		{
+			return encodeColors(output, capacity, rgb, leds, calibration, true, true, sequence, presentationTime);
+		}
+
+		/**
+		 * @brief Encode the remap table frame
+		 *
+		 * @param output
+		 * @param capacity size of the output buffer
+		 * @param table physical LED index for every logical LED
+		 * @param leds 1-65536
+		 * @return size_t the frame size, 0 if the LED count is invalid or the buffer is too small
+		 */
+		static size_t encodeRemapFrame(uint8_t* output, size_t capacity, const uint16_t* table, int leds)
+		{
+			size_t size = getRemapFrameSize(leds);
+
+			if (leds < 1 || leds > PROTOCOL_MAX_LEDS || size > capacity)
+				return 0;
+
+			uint8_t* payload = output + HEADER_SIZE;
+
+			writeHeader(output, 'm', leds);
+			for (int i = 0; i < leds; i++)
+			{
+				payload[i * 2] = table[i] >> 8;
+				payload[i * 2 + 1] = table[i] & 0xff;
+			}
+
+			writeChecksum(payload, (size_t)leds * 2, payload + (size_t)leds * 2);
+			return size;
+		}
+
+		/**
+		 * @brief Encode the command (0x15: statistics and hello, 0x35: statistics, 0x55/0x56: telemetry on/off, 0x45: profiler,
+		 * 0x65: device clock, 0x75/0x76: frame pacing on/off, 0x85: ping)
+		 *
+		 * @param output
+		 * @param capacity size of the output buffer
+		 * @param command
+		 * @return size_t COMMAND_SIZE, 0 if the buffer is too small
+		 */
+		static size_t encodeCommand(uint8_t* output, size_t capacity, uint8_t command)
+		{
+			if (capacity < COMMAND_SIZE)
+				return 0;
+
+			output[0] = 'A';
+			output[1] = 'w';
+			output[2] = 'a';
+			output[3] = 0x2a;
+			output[4] = 0xa2;
+			output[5] = command;
+			return COMMAND_SIZE;
+		}
+
+	private:
+		static inline size_t getExtensionSize(bool sequenced, bool timed)
+		{
+			return ((sequenced || timed) ? SEQUENCE_SIZE : 0) + ((timed) ? PRESENTATION_SIZE : 0);
+		}
+
+		static size_t encodeColors(uint8_t* output, size_t capacity, const uint8_t* rgb, int leds, const Calibration* calibration,
+									bool sequenced, bool timed, uint16_t sequence, uint32_t presentationTime)
+		{
+			size_t size = getFrameSize(leds, calibration != nullptr, sequenced, timed);
+
+			if (leds < 1 || leds > PROTOCOL_MAX_LEDS || size > capacity)
+				return 0;
+
+			uint8_t* payload = output + HEADER_SIZE;
+			uint8_t* colors = payload + getExtensionSize(sequenced, timed);
+			size_t payloadSize = (colors - payload) + (size_t)leds * 3;
+
+			// the colors first: they can overlap the place of the sequence number
+			if (rgb != colors)
+				memmove(colors, rgb, (size_t)leds * 3);
+
+			if (timed)
+			{
+				writeHeader(output, (calibration != nullptr) ? 'P' : 'p', leds);
+				payload[2] = presentationTime >> 24;
+				payload[3] = (presentationTime >> 16) & 0xff;
+				payload[4] = (presentationTime >> 8) & 0xff;
+				payload[5] = presentationTime & 0xff;
+			}
+			else if (sequenced)
+				writeHeader(output, (calibration != nullptr) ? 'S' : 's', leds);
+			else
+				writeHeader(output, (calibration != nullptr) ? 'A' : 'a', leds);
+
+			if (sequenced || timed)
+			{
+				payload[0] = sequence >> 8;
+				payload[1] = sequence & 0xff;
+			}
+
+			if (calibration != nullptr)
+			{
+				payload[payloadSize++] = calibration->gain;
+				payload[payloadSize++] = calibration->red;
+				payload[payloadSize++] = calibration->green;
+				payload[payloadSize++] = calibration->blue;
+			}
+
+			writeChecksum(payload, payloadSize, payload + payloadSize);
+			return size;
+		}
+};
+
+#endif
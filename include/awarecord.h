@@ -0,0 +1,125 @@
+/* awarecord.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef AWARECORD_H
+#define AWARECORD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Receiver of the binary device records for the tests and the host tools (the firmware only sends them).
+ * Record: 0xA5 0x5A, type, payload size (up to 64), payload, XOR of the payload bytes.
+ * It takes the place of the serial port (txQueue.flush()), skips everything else and keeps the last record of the given type.
+ * With FLOW_CONTROL_XONXOFF it removes the escaping of the bytes after 0xA5 0x5A (0x7D, then the byte XOR 0x20).
+ *
+ */
+class AwaRecordReceiver
+{
+	static const size_t MAX_PAYLOAD = 64;
+
+	uint8_t type;
+	uint8_t record[MAX_PAYLOAD + 5];
+	size_t position = 0;
+	bool escaped = false;
+
+	public:
+		int count = 0;
+		size_t size = 0;
+		uint8_t last[MAX_PAYLOAD];
+
+		AwaRecordReceiver(uint8_t _type) : type(_type) {}
+
+		int availableForWrite()
+		{
+			return 128;
+		}
+
+		size_t write(const uint8_t* data, size_t length)
+		{
+			for (size_t i = 0; i < length; i++)
+			{
+				uint8_t value = data[i];
+
+				#if defined(FLOW_CONTROL_XONXOFF)
+					if (position >= 2 && !escaped && value == 0x7D)
+					{
+						escaped = true;
+						continue;
+					}
+					if (escaped)
+					{
+						value ^= 0x20;
+						escaped = false;
+					}
+				#endif
+
+				if ((position == 0 && value != 0xA5) || (position == 1 && value != 0x5A) || (position == 3 && value > MAX_PAYLOAD))
+				{
+					position = (value == 0xA5) ? 1 : 0;
+					continue;
+				}
+
+				record[position++] = value;
+				if (position > 3 && position == (size_t)record[3] + 5)
+				{
+					uint8_t checksum = 0;
+
+					for (size_t j = 0; j < record[3]; j++)
+						checksum ^= record[4 + j];
+
+					if (record[2] == type && checksum == record[4 + record[3]])
+					{
+						size = record[3];
+						memcpy(last, &(record[4]), size);
+						count++;
+					}
+					position = 0;
+				}
+			}
+			return length;
+		}
+
+		/**
+		 * @brief Get the payload of the last record
+		 *
+		 * @tparam T packed record structure
+		 * @return T
+		 */
+		template <typename T>
+		T getLast()
+		{
+			T result;
+
+			memset(&result, 0, sizeof(result));
+			memcpy(&result, last, (sizeof(result) < size) ? sizeof(result) : size);
+			return result;
+		}
+};
+
+#endif
@@ -28,8 +28,27 @@
 #ifndef BASE_H
 #define BASE_H
 
+#include <atomic>
 #include "freertos/semphr.h"
 
+#if defined(PREALLOCATE_LED_STRIPS)
+	#if !defined(PREALLOCATE_MAX_LEDS)
+		#error "Set PREALLOCATE_MAX_LEDS to the number of the connected LEDs: the whole reserved strip is sent on every refresh"
+	#elif PREALLOCATE_MAX_LEDS > MAX_LEDS
+		#error "PREALLOCATE_MAX_LEDS can't be greater than MAX_LEDS"
+	#elif defined(SECOND_SEGMENT_START_INDEX) && PREALLOCATE_MAX_LEDS <= SECOND_SEGMENT_START_INDEX
+		#error "PREALLOCATE_MAX_LEDS must be greater than SECOND_SEGMENT_START_INDEX for preallocated LED strips"
+	#endif
+#endif
+
+#if defined(USE_PSRAM)
+	#include "esp_heap_caps.h"
+
+	#if !defined(PSRAM_MALLOC_THRESHOLD)
+		#define PSRAM_MALLOC_THRESHOLD 2048
+	#endif
+#endif
+
 #if defined(SECOND_SEGMENT_START_INDEX)
 	#if !defined(SECOND_SEGMENT_DATA_PIN)
 		#error "Please define SECOND_SEGMENT_DATA_PIN for second segment"
@@ -42,6 +61,10 @@ class Base
 {
 	// LED strip number
 	int ledsNumber = 0;
+	#if defined(PREALLOCATE_LED_STRIPS)
+		// length of the LED strips (all segments)
+		int reservedLeds = 0;
+	#endif
 	// NeoPixelBusLibrary primary object
 	LED_DRIVER* ledStrip1 = nullptr;
 	// NeoPixelBusLibrary second object
@@ -49,18 +72,98 @@ class Base
 	// frame is set and ready to render
 	bool readyToRender = false;
 
+	/**
+	 * @brief Create LED strip objects for the given number of LEDs (release the previous ones)
+	 *
+	 * @param count
+	 */
+	void createLedStrips(int count)
+	{
+		if (ledStrip1 != nullptr)
+		{
+			delete ledStrip1;
+			ledStrip1 = nullptr;
+		}
+
+		if (ledStrip2 != nullptr)
+		{
+			delete ledStrip2;
+			ledStrip2 = nullptr;
+		}
+
+		#if defined(SECOND_SEGMENT_START_INDEX)
+			if (count > SECOND_SEGMENT_START_INDEX)
+			{
+				#if defined(NEOPIXEL_RGBW) || defined(NEOPIXEL_RGB)
+					ledStrip1 = new LED_DRIVER(SECOND_SEGMENT_START_INDEX, DATA_PIN);
+					ledStrip1->Begin();
+					ledStrip2 = new LED_DRIVER2(count - SECOND_SEGMENT_START_INDEX, SECOND_SEGMENT_DATA_PIN);
+					ledStrip2->Begin();
+				#else
+					ledStrip1 = new LED_DRIVER(SECOND_SEGMENT_START_INDEX);
+					ledStrip1->Begin(CLOCK_PIN, 12, DATA_PIN, 15);
+					ledStrip2 = new LED_DRIVER2(count - SECOND_SEGMENT_START_INDEX);
+					ledStrip2->Begin(SECOND_SEGMENT_CLOCK_PIN, 12, SECOND_SEGMENT_DATA_PIN, 15);
+				#endif
+			}
+		#endif
+
+		if (ledStrip1 == nullptr)
+		{
+			#if defined(NEOPIXEL_RGBW) || defined(NEOPIXEL_RGB)
+				ledStrip1 = new LED_DRIVER(count, DATA_PIN);
+				ledStrip1->Begin();
+			#else
+				ledStrip1 = new LED_DRIVER(count);
+				ledStrip1->Begin(CLOCK_PIN, 12, DATA_PIN, 15);
+			#endif
+		}
+	}
+
 	public:
-		// static data buffer for the loop
-		uint8_t buffer[MAX_BUFFER + 1] = {0};
+		#if defined(USE_PSRAM)
+			// data buffer for the loop, allocated by initBuffers()
+			uint8_t* buffer = nullptr;
+		#else
+			// static data buffer for the loop
+			uint8_t buffer[MAX_BUFFER + 1] = {0};
+		#endif
 		// handle to tasks
 		TaskHandle_t processDataHandle = nullptr;
 		TaskHandle_t processSerialHandle = nullptr;
 		// semaphore to synchronize them
 		xSemaphoreHandle i2sXSemaphore;
-		// current queue position
-		volatile int queueCurrent = 0;
-		// queue end position
-		volatile int queueEnd = 0;
+		// current queue position, written by the processing task (release: the bytes before it can be overwritten)
+		std::atomic<int> queueCurrent{0};
+		// queue end position, written by the serial task (release: the bytes before it are in the buffer)
+		std::atomic<int> queueEnd{0};
+		// the serial driver reported lost data (FIFO overflow, buffer full)
+		std::atomic<bool> dataLost{false};
+		// queue position where the lost data was, -1 if none
+		std::atomic<int> lossPosition{-1};
+		// the data buffer was full at the last read (used only by the serial task)
+		bool ringFull = false;
+
+		#if defined(USE_PSRAM)
+			/**
+			 * @brief Enable PSRAM for large allocations (LED strip pixel buffers, remap table)
+			 * and allocate the data buffer. The buffer prefers internal RAM because it's hot decode path.
+			 * DMA buffers of the LED drivers are always allocated by NeoPixelBus from DMA-capable internal RAM.
+			 *
+			 * @return true if the data buffer was allocated
+			 */
+			bool initBuffers()
+			{
+				if (psramFound())
+					heap_caps_malloc_extmem_enable(PSRAM_MALLOC_THRESHOLD);
+
+				buffer = (uint8_t*)heap_caps_calloc(MAX_BUFFER + 1, 1, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+				if (buffer == nullptr && psramFound())
+					buffer = (uint8_t*)heap_caps_calloc(MAX_BUFFER + 1, 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+
+				return (buffer != nullptr);
+			}
+		#endif
 
 		inline int getLedsNumber()
 		{
@@ -77,49 +180,57 @@ class Base
 			return ledStrip2;
 		}
 
-		void initLedStrip(int count)
-		{
-			if (ledStrip1 != nullptr)
-			{
-				delete ledStrip1;
-				ledStrip1 = nullptr;
-			}
-
-			if (ledStrip2 != nullptr)
+		#if defined(PREALLOCATE_LED_STRIPS)
+			/**
+			 * @brief Reserve LED strip buffers for PREALLOCATE_MAX_LEDS once, the LED count changes within it won't allocate memory
+			 *
+			 */
+			void reserveLedStrips()
 			{
-				delete ledStrip2;
-				ledStrip2 = nullptr;
+				if (ledStrip1 == nullptr)
+				{
+					createLedStrips(PREALLOCATE_MAX_LEDS);
+					reservedLeds = PREALLOCATE_MAX_LEDS;
+				}
 			}
+		#endif
 
-			ledsNumber = count;
+		/**
+		 * @brief Set the active number of LEDs (recreate the LED strips if they are not preallocated)
+		 *
+		 * @param count
+		 */
+		void initLedStrip(int count)
+		{
+			#if defined(PREALLOCATE_LED_STRIPS)
+				reserveLedStrips();
 
-			#if defined(SECOND_SEGMENT_START_INDEX)
-				if (ledsNumber > SECOND_SEGMENT_START_INDEX)
+				// more LEDs than reserved: the strips grow (once)
+				if (count > reservedLeds)
+				{
+					createLedStrips(count);
+					reservedLeds = count;
+				}
+				// blank the LEDs that are not used anymore
+				else if (count < ledsNumber)
 				{
-					#if defined(NEOPIXEL_RGBW) || defined(NEOPIXEL_RGB)
-						ledStrip1 = new LED_DRIVER(SECOND_SEGMENT_START_INDEX, DATA_PIN);
-						ledStrip1->Begin();
-						ledStrip2 = new LED_DRIVER2(ledsNumber - SECOND_SEGMENT_START_INDEX, SECOND_SEGMENT_DATA_PIN);
-						ledStrip2->Begin();
+					#if defined(SECOND_SEGMENT_START_INDEX)
+						if (count < SECOND_SEGMENT_START_INDEX)
+							ledStrip1->ClearTo(ColorDefinition(), count, ledStrip1->PixelCount() - 1);
+						ledStrip2->ClearTo(ColorDefinition(), max(count - SECOND_SEGMENT_START_INDEX, 0), ledStrip2->PixelCount() - 1);
 					#else
-						ledStrip1 = new LED_DRIVER(SECOND_SEGMENT_START_INDEX);
-						ledStrip1->Begin(CLOCK_PIN, 12, DATA_PIN, 15);
-						ledStrip2 = new LED_DRIVER2(ledsNumber - SECOND_SEGMENT_START_INDEX);
-						ledStrip2->Begin(SECOND_SEGMENT_CLOCK_PIN, 12, SECOND_SEGMENT_DATA_PIN, 15);
+						ledStrip1->ClearTo(ColorDefinition(), count, ledStrip1->PixelCount() - 1);
 					#endif
 				}
+
+				ledsNumber = count;
+			#else
+				ledsNumber = count;
+				createLedStrips(count);
 			#endif
 
-			if (ledStrip1 == nullptr)
-			{
-				#if defined(NEOPIXEL_RGBW) || defined(NEOPIXEL_RGB)
-					ledStrip1 = new LED_DRIVER(ledsNumber, DATA_PIN);
-					ledStrip1->Begin();
-				#else
-					ledStrip1 = new LED_DRIVER(ledsNumber);
-					ledStrip1->Begin(CLOCK_PIN, 12, DATA_PIN, 15);
-				#endif
-			}
+			// the queued frames were for the previous layout, the host gets them acknowledged
+			frameQueue.clear();
 		}
 
 		/**
@@ -135,48 +246,232 @@ class Base
 
 		inline void dropLateFrame()
 		{
+			if (readyToRender)
+				errorStatistics.increase(ErrorType::LATE_DROP);
 			readyToRender = false;
 		}
 
+		/**
+		 * @brief Check if all segments can take the next frame (and refine their predicted busy time)
+		 *
+		 * @return true
+		 * @return false
+		 */
+		inline bool canShowLeds()
+		{
+			return (ledStrip1 != nullptr && renderScheduler.probe(0, ledStrip1->CanShow())) &&
+					!(ledStrip2 != nullptr && !renderScheduler.probe(1, ledStrip2->CanShow()));
+		}
+
+		/**
+		 * @brief Send the content of the LED strip buffers to the segments
+		 *
+		 * @param frameStart first header byte of the frame (cycles)
+		 * @param frameDecoded last checksum byte of the frame (cycles)
+		 */
+		inline void showLeds(uint32_t frameStart, uint32_t frameDecoded)
+		{
+			uint32_t showStart = ESP.getCycleCount();
+			unsigned long segmentStart = micros();
+
+			statistics.increaseShow();
+
+			// display segments
+			PROFILE_START(SHOW);
+			ledStrip1->Show(false);
+			renderScheduler.markShow(0, segmentStart, micros());
+			if (ledStrip2 != nullptr)
+			{
+				segmentStart = micros();
+				ledStrip2->Show(false);
+				renderScheduler.markShow(1, segmentStart, micros());
+			}
+			PROFILE_END(SHOW);
+
+			latency.markFrameShown(showStart, frameStart, frameDecoded);
+		}
+
 		inline void renderLeds(bool newFrame)
 		{
 			if (newFrame)
 				readyToRender = true;
 
-			if (readyToRender &&
-				(ledStrip1 != nullptr && ledStrip1->CanShow()) &&
-				!(ledStrip2 != nullptr && !ledStrip2->CanShow()))
+			if (readyToRender && canShowLeds())
 			{
-				statistics.increaseShow();
 				readyToRender = false;
+				showLeds(latency.getFrameStart(), latency.getFrameDecoded());
+			}
+			else if (readyToRender)
+			{
+				if (newFrame)
+					statistics.increaseLate();
+
+				// the bus is busy: render the frame as soon as it's predicted to be free
+				renderScheduler.schedule();
+			}
+		}
+
+		/**
+		 * @brief Get the size of the LED strip buffers (all segments)
+		 *
+		 * @return size_t
+		 */
+		inline size_t getPixelsSize()
+		{
+			return ((ledStrip1 != nullptr) ? ledStrip1->PixelsSize() : 0) + ((ledStrip2 != nullptr) ? ledStrip2->PixelsSize() : 0);
+		}
+
+		/**
+		 * @brief Copy the LED strip buffers to the frame slot
+		 *
+		 * @param slot getPixelsSize() bytes
+		 */
+		inline void savePixels(uint8_t* slot)
+		{
+			memcpy(slot, ledStrip1->Pixels(), ledStrip1->PixelsSize());
+			if (ledStrip2 != nullptr)
+				memcpy(slot + ledStrip1->PixelsSize(), ledStrip2->Pixels(), ledStrip2->PixelsSize());
+		}
 
-				// display segments
-				ledStrip1->Show(false);
-				if (ledStrip2 != nullptr)
-					ledStrip2->Show(false);
+		/**
+		 * @brief Copy the frame slot to the LED strip buffers
+		 *
+		 * @param slot getPixelsSize() bytes
+		 */
+		inline void restorePixels(const uint8_t* slot)
+		{
+			memcpy(ledStrip1->Pixels(), slot, ledStrip1->PixelsSize());
+			ledStrip1->Dirty();
+			if (ledStrip2 != nullptr)
+			{
+				memcpy(ledStrip2->Pixels(), slot + ledStrip1->PixelsSize(), ledStrip2->PixelsSize());
+				ledStrip2->Dirty();
 			}
 		}
 
+		/**
+		 * @brief Hold the decoded frame (the content of the LED strip buffers) in the frame queue until its presentation time.
+		 * The frame is dropped if the time has already passed. Without the queue storage or with the invalid time it's shown now.
+		 *
+		 * @param presentAt presentation time (micros())
+		 * @param sequenced
+		 * @param sequence
+		 * @return true if the frame went to the queue (the acknowledgement follows when it leaves it)
+		 */
+		bool presentFrame(unsigned long presentAt, bool sequenced, uint16_t sequence)
+		{
+			int32_t wait = (int32_t)(presentAt - micros());
+
+			if (wait < -PRESENTATION_TOLERANCE_US)
+			{
+				errorStatistics.increase(ErrorType::EXPIRED);
+				return false;
+			}
+
+			if ((wait <= 0 && frameQueue.isEmpty()) || wait > PRESENTATION_MAX_DELAY_US || !frameQueue.reserve(getPixelsSize()))
+			{
+				renderLeds(true);
+				return false;
+			}
+
+			uint8_t* slot = frameQueue.push(presentAt, sequenced, sequence, latency.getFrameStart(), latency.getFrameDecoded());
+
+			if (slot == nullptr)
+			{
+				errorStatistics.increase(ErrorType::QUEUE_FULL);
+				return false;
+			}
+
+			savePixels(slot);
+			renderQueuedFrames();
+			return true;
+		}
+
+		/**
+		 * @brief Show the queued frame at its presentation time, drop the expired ones and wake up the processing task
+		 * for the next one. The LED strip buffers keep the frame being decoded meanwhile.
+		 *
+		 */
+		void renderQueuedFrames()
+		{
+			unsigned long now = micros();
+
+			// the newer frame that is due makes the older ones obsolete, so does the tolerance
+			while (!frameQueue.isEmpty() &&
+					((frameQueue.getCount() > 1 && (int32_t)(frameQueue.getTime(1) - now) <= 0) ||
+					 (int32_t)(now - frameQueue.getTime(0)) > PRESENTATION_TOLERANCE_US))
+			{
+				errorStatistics.increase(ErrorType::EXPIRED);
+				frameAck.frameDone(frameQueue.isSequenced(), frameQueue.getSequence());
+				frameQueue.pop();
+			}
+
+			if (frameQueue.isEmpty())
+				return;
+
+			if ((int32_t)(frameQueue.getTime(0) - now) > 0)
+				renderScheduler.wakeAt(frameQueue.getTime(0));
+			else if (canShowLeds())
+			{
+				uint8_t* scratch = frameQueue.getScratch();
+
+				// Show() encodes the pixels for the bus right away, so the decoded frame can go back to the buffers
+				savePixels(scratch);
+				restorePixels(frameQueue.front());
+				showLeds(frameQueue.getFrameStart(), frameQueue.getFrameDecoded());
+				restorePixels(scratch);
+
+				frameAck.frameDone(frameQueue.isSequenced(), frameQueue.getSequence());
+				frameQueue.pop();
+
+				if (!frameQueue.isEmpty())
+					renderScheduler.wakeAt(frameQueue.getTime(0));
+			}
+			else
+				renderScheduler.schedule();
+		}
+
+		inline bool hasQueuedFrames()
+		{
+			return !frameQueue.isEmpty();
+		}
+
+		/**
+		 * @brief Drop the queued frames without showing them (the frame pacing was disabled)
+		 *
+		 */
+		inline void dropQueuedFrames()
+		{
+			frameQueue.clear();
+		}
+
 		inline bool setStripPixel(uint16_t pix, ColorDefinition &inputColor)
 		{
-			if (pix < ledsNumber)
+			PROFILE_START(SET_PIXEL);
+
+			// translate the logical index using the uploaded remap table (if any)
+			uint16_t target = remapTable.map(pix);
+
+			if (target < ledsNumber)
 			{
 				#if defined(SECOND_SEGMENT_START_INDEX)
-					if (pix < SECOND_SEGMENT_START_INDEX)
-						ledStrip1->SetPixelColor(pix, inputColor);
+					if (target < SECOND_SEGMENT_START_INDEX)
+						ledStrip1->SetPixelColor(target, inputColor);
 					else
 					{
 						#if defined(SECOND_SEGMENT_REVERSED)
-							ledStrip2->SetPixelColor(ledsNumber - pix - 1, inputColor);
+							ledStrip2->SetPixelColor(ledsNumber - target - 1, inputColor);
 						#else
-							ledStrip2->SetPixelColor(pix - SECOND_SEGMENT_START_INDEX, inputColor);
+							ledStrip2->SetPixelColor(target - SECOND_SEGMENT_START_INDEX, inputColor);
 						#endif
 					}
 				#else
-					ledStrip1->SetPixelColor(pix, inputColor);
+					ledStrip1->SetPixelColor(target, inputColor);
 				#endif
 			}
 
+			PROFILE_END(SET_PIXEL);
+
 			return (pix + 1 < ledsNumber);
 		}
 } base;
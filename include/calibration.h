@@ -37,6 +37,7 @@
 
 #include <stdint.h>
 #include <algorithm>
+#include "txqueue.h"
 
 #define ROUND_DIVIDE(numer, denom) (((numer) + (denom) / 2) / (denom))
 
@@ -113,17 +114,27 @@ class CalibrationConfig
 			}
 		}
 
+		/**
+		 * @brief format RGBW calibration parameters as the text
+		 *
+		 * @param output
+		 * @param size
+		 */
+		void formatCalibration(char* output, size_t size)
+		{
+			snprintf(output, size, "RGBW => Gain: %i/255, red: %i, green: %i, blue: %i\r\n", gain, red, green, blue);
+		}
+
 		/**
 		 * @brief print RGBW calibration parameters when no data is received
 		 *
 		 */
 		void printCalibration()
 		{
-			#ifdef SerialPort
-				char output[128];
-				snprintf(output, sizeof(output),"RGBW => Gain: %i/255, red: %i, green: %i, blue: %i\r\n", gain, red, green, blue);
-				SerialPort.print(output);
-			#endif
+			char output[128];
+
+			formatCalibration(output, sizeof(output));
+			txQueue.print(output);
 		}
 } calibrationConfig;
 #endif
@@ -0,0 +1,63 @@
+/* clocksync.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef CLOCKSYNC_H
+#define CLOCKSYNC_H
+
+#define CLOCK_RECORD_TYPE 'C'
+
+/**
+ * @brief Clock record (little-endian), the answer to the clock synchronization command
+ *
+ */
+struct __attribute__((packed)) ClockRecord
+{
+	uint32_t deviceTime;		// micros() when the command was decoded
+};
+
+/**
+ * @brief Device clock for the presentation time of the frames. The host sends the command, takes the device time
+ * as the middle of the round trip and keeps the sample with the shortest one (the least queuing).
+ *
+ */
+class
+{
+	public:
+		/**
+		 * @brief Queue the current device time, it never waits for the serial port
+		 *
+		 */
+		void reply()
+		{
+			ClockRecord record;
+
+			record.deviceTime = (uint32_t)micros();
+			txQueue.writeRecord(CLOCK_RECORD_TYPE, &record, sizeof(record));
+		}
+} clockSync;
+
+#endif
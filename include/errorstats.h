@@ -0,0 +1,182 @@
+/* errorstats.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef ERRORSTATS_H
+#define ERRORSTATS_H
+
+#include <atomic>
+
+/**
+ * @brief Categories of the errors
+ *
+ */
+enum class ErrorType
+{
+	HEADER_CRC,
+	FLETCHER1,
+	FLETCHER2,
+	FLETCHER_EXT,
+	OVERSIZE,
+	REINIT,
+	RING_OVERRUN,
+	LATE_DROP,
+	EXPIRED,
+	QUEUE_FULL,
+	UART_FIFO_OVERFLOW,
+	UART_BUFFER_FULL,
+	COUNT
+};
+
+/**
+ * @brief Lifetime 32-bit error counters and rolling 1s/10s/60s windows.
+ * RING_OVERRUN is updated by the serial task, UART_* by the serial driver event task, the other counters by the processing task.
+ *
+ */
+class
+{
+	enum { TYPES = (int)ErrorType::COUNT, HISTORY = 60 };
+
+	std::atomic<uint32_t> totals[TYPES] = {};
+	// lifetime totals at the beginning of the current second
+	uint32_t snapshot[TYPES] = {0};
+	// errors in every of the last seconds
+	uint32_t history[HISTORY][TYPES] = {{0}};
+	int historyIndex = 0;
+	unsigned long secondStart = 0;
+
+	public:
+		/**
+		 * @brief Get the name of the error type
+		 *
+		 * @param type
+		 * @return const char*
+		 */
+		static const char* getName(ErrorType type)
+		{
+			static const char* names[] = { "header CRC", "fletcher1", "fletcher2", "fletcherExt", "oversize", "reinit", "ring overrun",
+											"late drop", "expired", "queue full", "uart fifo overflow", "uart buffer full" };
+
+			return ((int)type < TYPES) ? names[(int)type] : "unknown";
+		}
+
+		/**
+		 * @brief Count the error
+		 *
+		 * @param type
+		 */
+		inline void increase(ErrorType type)
+		{
+			totals[(int)type].fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief Get the lifetime total
+		 *
+		 * @param type
+		 * @return uint32_t
+		 */
+		inline uint32_t getTotal(ErrorType type)
+		{
+			return totals[(int)type];
+		}
+
+		/**
+		 * @brief Get all checksum errors
+		 *
+		 * @return uint32_t
+		 */
+		inline uint32_t getChecksumErrors()
+		{
+			return totals[(int)ErrorType::FLETCHER1] + totals[(int)ErrorType::FLETCHER2] + totals[(int)ErrorType::FLETCHER_EXT];
+		}
+
+		/**
+		 * @brief Get the number of errors in the last completed seconds
+		 *
+		 * @param type
+		 * @param seconds 1-60
+		 * @return uint32_t
+		 */
+		uint32_t getWindow(ErrorType type, int seconds)
+		{
+			uint32_t sum = 0;
+
+			for (int i = 1; i <= seconds; i++)
+				sum += history[(historyIndex - i + HISTORY) % HISTORY][(int)type];
+
+			return sum;
+		}
+
+		/**
+		 * @brief Close the elapsed seconds of the rolling windows
+		 *
+		 * @param currentTime
+		 */
+		void update(unsigned long currentTime)
+		{
+			unsigned long elapsed = (currentTime - secondStart) / 1000;
+
+			if (elapsed == 0)
+				return;
+
+			for (unsigned long second = 0; second < std::min(elapsed, (unsigned long)HISTORY); second++)
+			{
+				for (int i = 0; i < TYPES; i++)
+				{
+					uint32_t total = totals[i];
+
+					history[historyIndex][i] = total - snapshot[i];
+					snapshot[i] = total;
+				}
+
+				historyIndex = (historyIndex + 1) % HISTORY;
+			}
+
+			secondStart += elapsed * 1000;
+		}
+
+		/**
+		 * @brief Print lifetime totals and the rolling windows
+		 *
+		 */
+		void print()
+		{
+			char output[128];
+
+			for (int i = 0; i < TYPES; i++)
+			{
+				ErrorType type = (ErrorType)i;
+
+				snprintf(output, sizeof(output), "Errors %s: total: %u, 60s: %u, 10s: %u, 1s: %u\r\n", getName(type),
+							(unsigned int)getTotal(type), (unsigned int)getWindow(type, 60),
+							(unsigned int)getWindow(type, 10), (unsigned int)getWindow(type, 1));
+				txQueue.print(output);
+			}
+		}
+} errorStatistics;
+
+#endif
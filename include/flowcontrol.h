@@ -0,0 +1,131 @@
+/* flowcontrol.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef FLOWCONTROL_H
+#define FLOWCONTROL_H
+
+#include <atomic>
+
+#if !defined(FLOW_CONTROL_HIGH)
+	#define FLOW_CONTROL_HIGH (MAX_BUFFER * 3 / 4)
+#endif
+
+#if !defined(FLOW_CONTROL_LOW)
+	#define FLOW_CONTROL_LOW (MAX_BUFFER / 4)
+#endif
+
+#define FLOW_CONTROL_XON 0x11
+#define FLOW_CONTROL_XOFF 0x13
+
+/**
+ * @brief Throttles the host at the UART level when the decoder falls behind: the host is stopped when the data buffer
+ * occupancy reaches FLOW_CONTROL_HIGH and released when it drops to FLOW_CONTROL_LOW.
+ * FLOW_CONTROL_RTS_PIN: the RTS line (active low, connect it to CTS of the host), FLOW_CONTROL_XONXOFF: XON/XOFF characters.
+ * The data sent before the host reacts goes to the rest of the data buffer and to the serial driver buffer.
+ * Runs in the serial task (the only writer of the serial port).
+ *
+ */
+class
+{
+	bool stopped = false;
+	// number of the times the host was stopped (read by the processing task)
+	std::atomic<uint32_t> stops{0};
+
+	inline void signal(bool stop)
+	{
+		#if defined(FLOW_CONTROL_RTS_PIN)
+			digitalWrite(FLOW_CONTROL_RTS_PIN, (stop) ? HIGH : LOW);
+		#else
+			SerialPort.write((uint8_t)((stop) ? FLOW_CONTROL_XOFF : FLOW_CONTROL_XON));
+		#endif
+	}
+
+	public:
+		/**
+		 * @brief Let the host send (it also releases the host stopped before the reset)
+		 *
+		 */
+		void init()
+		{
+			#if defined(FLOW_CONTROL_RTS_PIN)
+				pinMode(FLOW_CONTROL_RTS_PIN, OUTPUT);
+			#endif
+			stopped = false;
+			signal(false);
+		}
+
+		/**
+		 * @brief Stop or release the host according to the data buffer occupancy
+		 *
+		 * @param occupancy bytes waiting for the decoder
+		 */
+		inline void update(int occupancy)
+		{
+			if (!stopped && occupancy >= FLOW_CONTROL_HIGH)
+			{
+				stopped = true;
+				stops.fetch_add(1, std::memory_order_relaxed);
+				signal(true);
+			}
+			else if (stopped && occupancy <= FLOW_CONTROL_LOW)
+			{
+				stopped = false;
+				signal(false);
+			}
+		}
+
+		inline bool isStopped()
+		{
+			return stopped;
+		}
+
+		inline uint32_t getStops()
+		{
+			return stops.load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief Print the thresholds and the number of stops
+		 *
+		 */
+		void print()
+		{
+			char output[128];
+
+			#if defined(FLOW_CONTROL_XONXOFF)
+				const char* mode = "XON/XOFF (escaped binary records)";
+			#else
+				const char* mode = "RTS";
+			#endif
+
+			snprintf(output, sizeof(output), "Flow control: %s, stop at %i, resume at %i, stops: %u\r\n", mode, FLOW_CONTROL_HIGH,
+						FLOW_CONTROL_LOW, (unsigned int)getStops());
+			txQueue.print(output);
+		}
+} flowControl;
+
+#endif
@@ -0,0 +1,127 @@
+/* frameack.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef FRAMEACK_H
+#define FRAMEACK_H
+
+#define ACK_RECORD_TYPE 'K'
+
+/**
+ * @brief Acknowledgement record (little-endian) of the sequenced frames
+ *
+ */
+struct __attribute__((packed)) AckRecord
+{
+	uint16_t received;			// sequence number of the last correctly received frame
+	uint16_t shown;				// sequence number of the last frame sent to the LED strip (or dropped)
+	uint32_t freeSpace;			// free bytes in the data buffer
+};
+
+/**
+ * @brief Acknowledgements of the frames with the sequence number ('s'/'S' header), so the host can limit
+ * the number of the frames in flight. Sent when the frame is received and again when a waiting frame is shown.
+ *
+ */
+class
+{
+	uint16_t received = 0;
+	uint16_t shown = 0;
+	// the frame in the LED strip buffer carries the sequence number and it's not shown yet
+	bool pending = false;
+	bool changed = false;
+
+	public:
+		/**
+		 * @brief The frame was received correctly
+		 *
+		 * @param sequenced
+		 * @param sequence
+		 */
+		inline void frameDecoded(bool sequenced, uint16_t sequence)
+		{
+			pending = sequenced;
+			if (sequenced)
+			{
+				received = sequence;
+				changed = true;
+			}
+		}
+
+		/**
+		 * @brief The received frame waits in the frame queue, frameDone() acknowledges it
+		 *
+		 */
+		inline void frameQueued()
+		{
+			pending = false;
+		}
+
+		/**
+		 * @brief The queued frame was shown or dropped
+		 *
+		 * @param sequenced
+		 * @param sequence
+		 */
+		inline void frameDone(bool sequenced, uint16_t sequence)
+		{
+			if (sequenced)
+			{
+				shown = sequence;
+				changed = true;
+			}
+		}
+
+		/**
+		 * @brief Queue the acknowledgement after the render attempt, it never waits for the serial port
+		 *
+		 * @param waitingForStrip the frame is still waiting for the LED strip
+		 * @param freeSpace
+		 */
+		void update(bool waitingForStrip, int freeSpace)
+		{
+			if (pending && !waitingForStrip)
+			{
+				shown = received;
+				pending = false;
+				changed = true;
+			}
+
+			if (!changed)
+				return;
+
+			AckRecord record;
+
+			record.received = received;
+			record.shown = shown;
+			record.freeSpace = freeSpace;
+
+			txQueue.writeRecord(ACK_RECORD_TYPE, &record, sizeof(record));
+			changed = false;
+		}
+} frameAck;
+
+#endif
@@ -0,0 +1,234 @@
+/* framepacer.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+// highest target depth of the jitter buffer (frames)
+#if !defined(FRAME_PACING_MAX_DEPTH)
+	#define FRAME_PACING_MAX_DEPTH (FRAME_QUEUE_SIZE - 1)
+#endif
+
+// the frames without an underrun before the target depth is lowered
+#if !defined(FRAME_PACING_RELAX_FRAMES)
+	#define FRAME_PACING_RELAX_FRAMES 600
+#endif
+
+// the host frame interval is measured over that time (us)
+#if !defined(FRAME_PACING_WINDOW_US)
+	#define FRAME_PACING_WINDOW_US 250000
+#endif
+
+// the longer gap between the frames is a pause of the stream: the pacing starts again (us)
+#if !defined(FRAME_PACING_GAP_US)
+	#define FRAME_PACING_GAP_US 100000
+#endif
+
+/**
+ * @brief Adaptive jitter buffer for the frames without the presentation time. The host frame interval is estimated
+ * from the arrivals and every frame gets the presentation time one interval after the previous one, so the frames
+ * received in bursts (USB-serial adapters) are shown at the steady rate. The delay follows the target depth:
+ * an underrun (the frame came after its turn) raises it, a long run without an underrun lowers it.
+ * Disabled by default (the lowest latency), enabled by FRAME_PACING or by the host command. Used only by the processing task.
+ *
+ */
+class
+{
+	#if defined(FRAME_PACING)
+		bool enabled = true;
+	#else
+		bool enabled = false;
+	#endif
+	// estimated host frame interval and the mean deviation of the arrivals from it (us)
+	int32_t interval = 0;
+	int32_t jitter = 0;
+	// the previous frame: arrival and presentation time (micros())
+	unsigned long lastArrival = 0;
+	unsigned long lastPresent = 0;
+	bool running = false;
+	// the arrivals since the start of the measurement window (micros())
+	unsigned long windowStart = 0;
+	int32_t windowFrames = 0;
+	// smoothed difference between the target and the cadence delay (us)
+	int32_t delayError = 0;
+	// target queue depth (frames) and the frames since the last underrun
+	int depth = 1;
+	int relaxFrames = 0;
+	// statistics since the last reset
+	uint32_t frames = 0;
+	uint32_t depthSum = 0;
+	int depthMax = 0;
+	uint64_t delaySum = 0;
+	uint32_t underruns = 0;
+
+	public:
+		inline bool isEnabled()
+		{
+			return enabled;
+		}
+
+		/**
+		 * @brief Enable or disable the pacing, the estimates start again
+		 *
+		 * @param newEnabled
+		 */
+		void setEnabled(bool newEnabled)
+		{
+			enabled = newEnabled;
+			running = false;
+			interval = 0;
+			jitter = 0;
+			depth = 1;
+			relaxFrames = 0;
+		}
+
+		/**
+		 * @brief The frame was received: update the estimates and assign its presentation time
+		 *
+		 * @param now micros()
+		 * @param queued frames already waiting in the frame queue
+		 * @return unsigned long presentation time (micros())
+		 */
+		unsigned long schedule(unsigned long now, int queued)
+		{
+			int32_t gap = now - lastArrival;
+			// the first frame or the stream was paused: it's shown after the target delay and the cadence starts from it
+			bool paced = running && (gap <= FRAME_PACING_GAP_US || gap <= interval * 4);
+
+			if (!paced)
+			{
+				windowStart = now;
+				windowFrames = 0;
+				delayError = 0;
+			}
+			else
+			{
+				// the bursts average out over the measurement window
+				windowFrames++;
+				if ((int32_t)(now - windowStart) >= FRAME_PACING_WINDOW_US)
+				{
+					int32_t measured = (int32_t)(now - windowStart) / windowFrames;
+
+					// the first estimate: the cadence starts from this frame
+					paced = (interval > 0);
+					interval = (interval == 0) ? measured : interval + (measured - interval) / 4;
+					windowStart = now;
+					windowFrames = 0;
+				}
+				else
+					paced = (interval > 0);
+				jitter += (abs(gap - interval) - jitter) / 16;
+			}
+
+			running = true;
+			lastArrival = now;
+
+			int32_t target = depth * interval;
+			unsigned long presentAt = now + target;
+
+			if (paced)
+			{
+				// one interval after the previous frame, the average delay is slowly steered to the target
+				presentAt = lastPresent + interval;
+				delayError += ((int32_t)(now + target - presentAt) - delayError) / 8;
+				presentAt += delayError / 32;
+
+				if ((int32_t)(presentAt - now) < 0)
+				{
+					// the frame came after its turn: show it now and keep more frames from now on
+					presentAt = now;
+					underruns++;
+					depth = min(depth + 1, FRAME_PACING_MAX_DEPTH);
+					relaxFrames = 0;
+				}
+				else if ((int32_t)(presentAt - now) > target + interval)
+					presentAt = now + target + interval;
+			}
+
+			if (++relaxFrames >= FRAME_PACING_RELAX_FRAMES && depth > 1)
+			{
+				depth--;
+				relaxFrames = 0;
+			}
+
+			lastPresent = presentAt;
+
+			frames++;
+			depthSum += queued + 1;
+			depthMax = max(depthMax, queued + 1);
+			delaySum += (uint32_t)(presentAt - now);
+
+			return presentAt;
+		}
+
+		inline uint32_t getUnderruns()
+		{
+			return underruns;
+		}
+
+		inline int getDepth()
+		{
+			return depth;
+		}
+
+		inline int32_t getInterval()
+		{
+			return interval;
+		}
+
+		/**
+		 * @brief Print the estimates, the queue depth and the added delay
+		 *
+		 */
+		void print()
+		{
+			char output[192];
+			uint32_t average = (frames > 0) ? (uint64_t)depthSum * 100 / frames : 0;
+
+			if (!enabled)
+				snprintf(output, sizeof(output), "Frame pacing: off\r\n");
+			else
+				snprintf(output, sizeof(output), "Frame pacing: interval %i us, jitter %i us, target depth %i, queue avg %u.%02u max %i, delay avg %u us, underruns: %u\r\n",
+							(int)interval, (int)jitter, depth, (unsigned int)(average / 100), (unsigned int)(average % 100), depthMax,
+							(unsigned int)((frames > 0) ? delaySum / frames : 0), (unsigned int)underruns);
+			txQueue.print(output);
+		}
+
+		/**
+		 * @brief Reset the statistics (the estimates are kept)
+		 *
+		 */
+		void reset()
+		{
+			frames = 0;
+			depthSum = 0;
+			depthMax = 0;
+			delaySum = 0;
+		}
+} framePacer;
+
+#endif
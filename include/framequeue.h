@@ -0,0 +1,192 @@
+/* framequeue.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef FRAMEQUEUE_H
+#define FRAMEQUEUE_H
+
+#if !defined(FRAME_QUEUE_SIZE)
+	#define FRAME_QUEUE_SIZE 4
+#endif
+
+// the frame shown later than that after its presentation time is dropped (us)
+#if !defined(PRESENTATION_TOLERANCE_US)
+	#define PRESENTATION_TOLERANCE_US 4000
+#endif
+
+// the presentation time further in the future is considered invalid (the clocks are not synchronized): shown right away (us)
+#if !defined(PRESENTATION_MAX_DELAY_US)
+	#define PRESENTATION_MAX_DELAY_US 1000000
+#endif
+
+/**
+ * @brief Committed frames waiting for their presentation time: copies of the LED strip buffers with the time (micros()),
+ * the sequence number and the receive timestamps. One more slot keeps the frame being decoded while a queued frame is shown.
+ * The storage is allocated on the first use for the current frame size. Used only by the processing task.
+ *
+ */
+class
+{
+	uint8_t* storage = nullptr;
+	// bytes per frame (all segments)
+	size_t frameSize = 0;
+	unsigned long presentAt[FRAME_QUEUE_SIZE] = {0};
+	// the frame carries the sequence number (acknowledged when it's shown)
+	bool sequenced[FRAME_QUEUE_SIZE] = {false};
+	uint16_t sequence[FRAME_QUEUE_SIZE] = {0};
+	// receive timestamps for the latency statistics (cycles)
+	uint32_t frameStart[FRAME_QUEUE_SIZE] = {0};
+	uint32_t frameDecoded[FRAME_QUEUE_SIZE] = {0};
+	int head = 0;
+	int count = 0;
+
+	public:
+		/**
+		 * @brief Prepare the storage for the frame size, the queued frames of the other size are dropped (and acknowledged)
+		 *
+		 * @param size bytes per frame
+		 * @return true if the storage is available
+		 */
+		bool reserve(size_t size)
+		{
+			if (size != frameSize || storage == nullptr)
+			{
+				clear();
+				free(storage);
+				storage = (uint8_t*)malloc(size * (FRAME_QUEUE_SIZE + 1));
+				frameSize = (storage != nullptr) ? size : 0;
+			}
+
+			return (storage != nullptr);
+		}
+
+		/**
+		 * @brief Drop the queued frames without showing them, the sequenced ones are acknowledged as done
+		 *
+		 */
+		void clear()
+		{
+			while (count > 0)
+			{
+				frameAck.frameDone(isSequenced(), getSequence());
+				pop();
+			}
+			head = 0;
+		}
+
+		inline int getCount()
+		{
+			return count;
+		}
+
+		inline bool isEmpty()
+		{
+			return (count == 0);
+		}
+
+		inline size_t getFrameSize()
+		{
+			return frameSize;
+		}
+
+		/**
+		 * @brief Add the frame at the end of the queue
+		 *
+		 * @param time presentation time (micros())
+		 * @param frameSequenced
+		 * @param frameSequence
+		 * @param start first header byte (cycles)
+		 * @param decoded last checksum byte (cycles)
+		 * @return uint8_t* the slot for the pixels or nullptr if the queue is full
+		 */
+		uint8_t* push(unsigned long time, bool frameSequenced, uint16_t frameSequence, uint32_t start, uint32_t decoded)
+		{
+			if (count >= FRAME_QUEUE_SIZE || storage == nullptr)
+				return nullptr;
+
+			int index = (head + count++) % FRAME_QUEUE_SIZE;
+
+			presentAt[index] = time;
+			sequenced[index] = frameSequenced;
+			sequence[index] = frameSequence;
+			frameStart[index] = start;
+			frameDecoded[index] = decoded;
+			return storage + index * frameSize;
+		}
+
+		/**
+		 * @brief Get the presentation time of the queued frame
+		 *
+		 * @param position 0 = the oldest
+		 * @return unsigned long
+		 */
+		inline unsigned long getTime(int position)
+		{
+			return presentAt[(head + position) % FRAME_QUEUE_SIZE];
+		}
+
+		inline bool isSequenced()
+		{
+			return sequenced[head];
+		}
+
+		inline uint16_t getSequence()
+		{
+			return sequence[head];
+		}
+
+		inline uint32_t getFrameStart()
+		{
+			return frameStart[head];
+		}
+
+		inline uint32_t getFrameDecoded()
+		{
+			return frameDecoded[head];
+		}
+
+		inline uint8_t* front()
+		{
+			return storage + head * frameSize;
+		}
+
+		inline void pop()
+		{
+			if (count > 0)
+			{
+				head = (head + 1) % FRAME_QUEUE_SIZE;
+				count--;
+			}
+		}
+
+		// the place for the LED strip content while a queued frame is shown
+		inline uint8_t* getScratch()
+		{
+			return storage + FRAME_QUEUE_SIZE * frameSize;
+		}
+} frameQueue;
+
+#endif
@@ -40,6 +40,11 @@ enum class AwaProtocol
 	HEADER_HI,
 	HEADER_LO,
 	HEADER_CRC,
+	SEQUENCE_HI,
+	SEQUENCE_LO,
+	PRESENTATION_TIME,
+	REMAP_HI,
+	REMAP_LO,
 	VERSION2_GAIN,
 	VERSION2_RED,
 	VERSION2_GREEN,
@@ -60,6 +65,12 @@ class
 {
 	volatile AwaProtocol state = AwaProtocol::HEADER_A;
 	bool protocolVersion2 = false;
+	bool remapFrame = false;
+	bool sequenced = false;
+	uint16_t sequence = 0;
+	bool timed = false;
+	uint32_t presentationTime = 0;
+	uint8_t presentationBytes = 0;
 	uint8_t CRC = 0;
 	uint16_t count = 0;
 	uint16_t currentLed = 0;
@@ -169,6 +180,122 @@ class
 			return protocolVersion2;
 		}
 
+		/**
+		 * @brief Set if the frame contains the LED remap table instead of colors
+		 *
+		 * @param newRemap
+		 */
+		inline void setRemapFrame(bool newRemap)
+		{
+			remapFrame = newRemap;
+		}
+
+		/**
+		 * @brief Verify if the frame contains the LED remap table
+		 *
+		 * @return true
+		 * @return false
+		 */
+		inline bool isRemapFrame()
+		{
+			return remapFrame;
+		}
+
+		/**
+		 * @brief Set if the frame carries the sequence number (acknowledged by the device)
+		 *
+		 * @param newSequenced
+		 */
+		inline void setSequenced(bool newSequenced)
+		{
+			sequenced = newSequenced;
+		}
+
+		/**
+		 * @brief Verify if the frame carries the sequence number
+		 *
+		 * @return true
+		 * @return false
+		 */
+		inline bool isSequenced()
+		{
+			return sequenced;
+		}
+
+		/**
+		 * @brief Set the high byte of the sequence number
+		 *
+		 * @param input
+		 */
+		inline void setSequenceHigh(uint8_t input)
+		{
+			sequence = input << 8;
+		}
+
+		/**
+		 * @brief Set the low byte of the sequence number
+		 *
+		 * @param input
+		 */
+		inline void setSequenceLow(uint8_t input)
+		{
+			sequence |= input;
+		}
+
+		/**
+		 * @brief Get the sequence number of the frame
+		 *
+		 * @return uint16_t
+		 */
+		inline uint16_t getSequence()
+		{
+			return sequence;
+		}
+
+		/**
+		 * @brief Set if the frame carries the presentation time (and the sequence number)
+		 *
+		 * @param newTimed
+		 */
+		inline void setTimed(bool newTimed)
+		{
+			timed = newTimed;
+			presentationBytes = 0;
+		}
+
+		/**
+		 * @brief Verify if the frame carries the presentation time
+		 *
+		 * @return true
+		 * @return false
+		 */
+		inline bool isTimed()
+		{
+			return timed;
+		}
+
+		/**
+		 * @brief Add the next byte of the presentation time (big endian)
+		 *
+		 * @param input
+		 * @return true if it was the last one
+		 */
+		inline bool addPresentationByte(uint8_t input)
+		{
+			presentationTime = (presentationTime << 8) | input;
+			return (++presentationBytes == 4);
+		}
+
+		/**
+		 * @brief Get the presentation time of the frame (micros() of the device)
+		 *
+		 * @return uint32_t
+		 */
+		inline uint32_t getPresentationTime()
+		{
+			return presentationTime;
+		}
+
 		/**
 		 * @brief  Set new AWA frame state
 		 *
@@ -207,9 +334,11 @@ class
 		 */
 		inline void addFletcher(byte input)
 		{
+			PROFILE_START(FLETCHER);
 			fletcher1 = (fletcher1 + (uint16_t)input) % 255;
 			fletcher2 = (fletcher2 + fletcher1) % 255;
 			fletcherExt = (fletcherExt + (input ^ (position++))) % 255;
+			PROFILE_END(FLETCHER);
 		}
 
 		/**
@@ -234,6 +363,7 @@ class
 			*/
 			inline void rgb2rgbw()
 			{
+				PROFILE_START(RGB2RGBW);
 				color.W = min(channelCorrection.red[color.R],
 								min(channelCorrection.green[color.G],
 									channelCorrection.blue[color.B]));
@@ -241,6 +371,7 @@ class
 				color.G -= channelCorrection.green[color.W];
 				color.B -= channelCorrection.blue[color.W];
 				color.W = channelCorrection.white[color.W];
+				PROFILE_END(RGB2RGBW);
 			}
 		#endif
 
@@ -0,0 +1,219 @@
+/* latency.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+/**
+ * @brief Fixed-bucket histogram of time intervals (microseconds).
+ * Buckets 0-3 hold exact values, next buckets split every power of two range into 4 parts (max. 25% error).
+ *
+ */
+class LatencyHistogram
+{
+	static const int MAX_BIT = 24;
+	static const int BUCKETS = 4 + (MAX_BIT - 2) * 4;
+
+	uint32_t buckets[BUCKETS] = {0};
+	uint32_t samples = 0;
+
+	static inline int getBucket(uint32_t value)
+	{
+		if (value < 4)
+			return value;
+
+		int msb = 31 - __builtin_clz(value);
+		if (msb >= MAX_BIT)
+			return BUCKETS - 1;
+
+		return 4 + (msb - 2) * 4 + ((value >> (msb - 2)) & 3);
+	}
+
+	static inline uint32_t getUpperBound(int bucket)
+	{
+		if (bucket < 4)
+			return bucket;
+
+		int msb = (bucket - 4) / 4 + 2;
+		return ((uint32_t)(4 + ((bucket - 4) & 3) + 1) << (msb - 2)) - 1;
+	}
+
+	public:
+		/**
+		 * @brief Add the sample
+		 *
+		 * @param value
+		 */
+		inline void add(uint32_t value)
+		{
+			buckets[getBucket(value)]++;
+			samples++;
+		}
+
+		/**
+		 * @brief Get number of samples
+		 *
+		 * @return uint32_t
+		 */
+		inline uint32_t getSamples()
+		{
+			return samples;
+		}
+
+		/**
+		 * @brief Get the percentile (upper bound of the bucket that contains it)
+		 *
+		 * @param percent
+		 * @return uint32_t
+		 */
+		uint32_t getPercentile(uint32_t percent)
+		{
+			if (samples == 0)
+				return 0;
+
+			uint32_t limit = (uint32_t)(((uint64_t)samples * percent + 99) / 100);
+			uint32_t total = 0;
+
+			for (int i = 0; i < BUCKETS; i++)
+			{
+				total += buckets[i];
+				if (total >= limit)
+					return getUpperBound(i);
+			}
+
+			return getUpperBound(BUCKETS - 1);
+		}
+
+		void reset()
+		{
+			memset(buckets, 0, sizeof(buckets));
+			samples = 0;
+		}
+};
+
+/**
+ * @brief Receive-to-photon latency of the frames measured using the CPU cycle counter
+ *
+ */
+class
+{
+	// timestamps of the frame being received (cycles)
+	uint32_t frameStart = 0;
+	// timestamps of the frame waiting to be shown (cycles)
+	uint32_t pendingStart = 0;
+	uint32_t pendingDecoded = 0;
+
+	inline uint32_t toMicros(uint32_t cycles)
+	{
+		return cycles / getCpuFrequencyMhz();
+	}
+
+	public:
+		// first header byte => last checksum byte
+		LatencyHistogram decode;
+		// last checksum byte => Show() (the frame waits for the LED strip or its presentation time)
+		LatencyHistogram queue;
+		// first header byte => Show() returns
+		LatencyHistogram total;
+
+		/**
+		 * @brief The first byte of the frame header is received
+		 *
+		 */
+		inline void markFrameStart()
+		{
+			frameStart = ESP.getCycleCount();
+		}
+
+		/**
+		 * @brief The last checksum byte of the frame is received and verified
+		 *
+		 */
+		inline void markFrameDecoded()
+		{
+			pendingStart = frameStart;
+			pendingDecoded = ESP.getCycleCount();
+			decode.add(toMicros(pendingDecoded - pendingStart));
+		}
+
+		/**
+		 * @brief Get the receive timestamps of the last decoded frame (the queued frame keeps them)
+		 *
+		 * @return uint32_t cycles
+		 */
+		inline uint32_t getFrameStart()
+		{
+			return pendingStart;
+		}
+
+		inline uint32_t getFrameDecoded()
+		{
+			return pendingDecoded;
+		}
+
+		/**
+		 * @brief The frame is sent to the LED strip
+		 *
+		 * @param showStart cycle counter before calling Show()
+		 * @param start first header byte of the frame (cycles)
+		 * @param decoded last checksum byte of the frame (cycles)
+		 */
+		inline void markFrameShown(uint32_t showStart, uint32_t start, uint32_t decoded)
+		{
+			uint32_t showEnd = ESP.getCycleCount();
+			queue.add(toMicros(showStart - decoded));
+			total.add(toMicros(showEnd - start));
+		}
+
+		/**
+		 * @brief Print percentiles of all histograms
+		 *
+		 */
+		void print()
+		{
+			char output[128];
+			LatencyHistogram* histograms[] = { &decode, &queue, &total };
+			const char* names[] = { "decode", "queue", "total" };
+
+			for (int i = 0; i < 3; i++)
+			{
+				snprintf(output, sizeof(output), "Latency %s (us): p50: %u, p95: %u, p99: %u, samples: %u\r\n", names[i],
+							(unsigned int)histograms[i]->getPercentile(50), (unsigned int)histograms[i]->getPercentile(95),
+							(unsigned int)histograms[i]->getPercentile(99), (unsigned int)histograms[i]->getSamples());
+				txQueue.print(output);
+			}
+		}
+
+		void reset()
+		{
+			decode.reset();
+			queue.reset();
+			total.reset();
+		}
+} latency;
+
+#endif
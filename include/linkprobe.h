@@ -0,0 +1,128 @@
+/* linkprobe.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef LINKPROBE_H
+#define LINKPROBE_H
+
+#define PING_RECORD_TYPE 'P'
+
+// number of the recent serial reads that keep their receive time
+#if !defined(LINK_PROBE_CHUNKS)
+	#define LINK_PROBE_CHUNKS 8
+#endif
+
+/**
+ * @brief Ping record (little-endian), the answer to the ping command
+ *
+ */
+struct __attribute__((packed)) PingRecord
+{
+	uint32_t receiveTime;		// micros() when the serial task read the command from the serial port
+	uint32_t replyTime;			// micros() when the command was decoded and the answer queued
+	uint32_t ringOccupancy;		// bytes waiting in the data buffer behind the command
+	uint16_t txQueued;			// bytes waiting in the output queue ahead of the answer
+};
+
+/**
+ * @brief Round-trip latency probe: the serial task keeps the end position and the time of its recent reads,
+ * so the answer to the ping command carries the moment the command came from the serial port besides the moment it was decoded.
+ * The host gets the link round trip, the queuing in the data buffer and the output queue under the real load.
+ *
+ */
+class
+{
+	// end position in the data buffer and micros() of the recent serial reads
+	std::atomic<int> chunkEnd[LINK_PROBE_CHUNKS];
+	std::atomic<uint32_t> chunkTime[LINK_PROBE_CHUNKS];
+	// number of the serial reads so far (only the serial task writes it)
+	std::atomic<uint32_t> chunks{0};
+
+	public:
+		/**
+		 * @brief The serial task read the data from the serial port (call it before publishing the new data)
+		 *
+		 * @param end position in the data buffer after the new data
+		 * @param time micros() of the read
+		 */
+		inline void markReceived(int end, unsigned long time)
+		{
+			uint32_t index = chunks.load(std::memory_order_relaxed);
+
+			chunkEnd[index % LINK_PROBE_CHUNKS].store(end, std::memory_order_relaxed);
+			chunkTime[index % LINK_PROBE_CHUNKS].store(time, std::memory_order_relaxed);
+			chunks.store(index + 1, std::memory_order_release);
+		}
+
+		/**
+		 * @brief Find the serial read that brought the byte before the given position. Going back from the newest read,
+		 * the reads that end between the position and the newest data are still waiting: the oldest of them brought it.
+		 *
+		 * @param position in the data buffer
+		 * @param fallback the time if the read is not known anymore
+		 * @return uint32_t micros()
+		 */
+		uint32_t getReceiveTime(int position, uint32_t fallback)
+		{
+			uint32_t last = chunks.load(std::memory_order_acquire);
+			uint32_t first = (last > LINK_PROBE_CHUNKS) ? last - LINK_PROBE_CHUNKS : 0;
+			uint32_t time = fallback;
+			int waiting = 0;
+
+			for (uint32_t i = last; i > first; i--)
+			{
+				int end = chunkEnd[(i - 1) % LINK_PROBE_CHUNKS].load(std::memory_order_relaxed);
+				int distance = (end - position + MAX_BUFFER) % MAX_BUFFER;
+
+				if (i == last)
+					waiting = distance;
+				else if (distance > waiting)
+					break;
+				time = chunkTime[(i - 1) % LINK_PROBE_CHUNKS].load(std::memory_order_relaxed);
+			}
+
+			return time;
+		}
+
+		/**
+		 * @brief Queue the answer to the ping command, it never waits for the serial port
+		 *
+		 * @param position in the data buffer after the command
+		 * @param queueEnd end of the published data
+		 */
+		void reply(int position, int queueEnd)
+		{
+			PingRecord record;
+
+			record.replyTime = (uint32_t)micros();
+			record.receiveTime = getReceiveTime(position, record.replyTime);
+			record.ringOccupancy = (queueEnd - position + MAX_BUFFER) % MAX_BUFFER;
+			record.txQueued = TX_QUEUE_SIZE - 1 - txQueue.getFree();
+			txQueue.writeRecord(PING_RECORD_TYPE, &record, sizeof(record));
+		}
+} linkProbe;
+
+#endif
@@ -28,13 +28,46 @@
 #ifndef MAIN_H
 #define MAIN_H
 
-#define MAX_BUFFER (3013 * 3 + 1)
+#if !defined(MAX_LEDS)
+	#define MAX_LEDS 4096
+#elif MAX_LEDS > 65535
+	#error "MAX_LEDS is limited to 65535 by the AWA protocol"
+#endif
+
+#if !defined(MAX_BUFFER)
+	#define MAX_BUFFER (3013 * 3 + 1)
+#endif
+
+// the decoder gives the consumed space back to the serial task at least every that many bytes
+#if !defined(QUEUE_RELEASE_BYTES)
+	#define QUEUE_RELEASE_BYTES 256
+#endif
+
 #define HELLO_MESSAGE "\r\nWelcome!\r\nAwa driver 9."
 
 #include "calibration.h"
+#include "txqueue.h"
+#include "profiler.h"
 #include "statistics.h"
+#include "errorstats.h"
+#include "latency.h"
+#include "telemetry.h"
+#include "frameack.h"
+#include "clocksync.h"
+#include "linkprobe.h"
+#include "remaptable.h"
+#include "renderscheduler.h"
+#include "framequeue.h"
+#include "framepacer.h"
 #include "base.h"
+#if defined(PERSISTENT_LED_CONFIG)
+	#include "persistentconfig.h"
+#endif
 #include "framestate.h"
+#if defined(FLOW_CONTROL_RTS_PIN) || defined(FLOW_CONTROL_XONXOFF)
+	#define FLOW_CONTROL_ENABLED
+	#include "flowcontrol.h"
+#endif
 
 /**
  * @brief separete thread on core 1 for handling serial communication using cyclic buffer
@@ -43,28 +76,74 @@
 
 bool serialTaskHandler()
 {
-	uint16_t incomingSize = min(SerialPort.available(), MAX_BUFFER - 1);
+	// the serial driver reported lost data: discard the rest of its buffer, so the gap is exactly at the buffer end
+	// only this task writes the queue end
+	int queueEnd = base.queueEnd.load(std::memory_order_relaxed);
+
+	if (base.dataLost.exchange(false))
+	{
+		uint8_t scratch[64];
+
+		for (int left = SerialPort.available(); left > 0; left -= sizeof(scratch))
+			SerialPort.read(scratch, min(left, (int)sizeof(scratch)));
+		base.lossPosition.store(queueEnd, std::memory_order_relaxed);
+	}
+
+	int incomingSize = SerialPort.available();
+	int freeSpace = MAX_BUFFER - 1 - (queueEnd - base.queueCurrent.load(std::memory_order_acquire) + MAX_BUFFER) % MAX_BUFFER;
+
+	// the decoder has fallen behind: never overwrite the unprocessed data, the rest waits in the serial driver.
+	// Counted once until the whole read fits again, the task polls the full buffer many times meanwhile.
+	if (incomingSize > freeSpace)
+	{
+		if (!base.ringFull)
+			errorStatistics.increase(ErrorType::RING_OVERRUN);
+		base.ringFull = true;
+		incomingSize = freeSpace;
+	}
+	else
+		base.ringFull = false;
 
 	if (incomingSize > 0)
 	{
-		if (base.queueEnd + incomingSize < MAX_BUFFER)
+		PROFILE_START(SERIAL_READ);
+		unsigned long receiveTime = micros();
+		statistics.setFirstByteTime(receiveTime);
+
+		if (queueEnd + incomingSize < MAX_BUFFER)
 		{
-			SerialPort.read(&(base.buffer[base.queueEnd]), incomingSize);
-			base.queueEnd += incomingSize;
+			SerialPort.read(&(base.buffer[queueEnd]), incomingSize);
+			queueEnd += incomingSize;
 		}
 		else
 		{
-			int left = MAX_BUFFER - base.queueEnd;
-			SerialPort.read(&(base.buffer[base.queueEnd]), left);
+			int left = MAX_BUFFER - queueEnd;
+			SerialPort.read(&(base.buffer[queueEnd]), left);
 			SerialPort.read(&(base.buffer[0]), incomingSize - left);
-			base.queueEnd = incomingSize - left;
+			queueEnd = incomingSize - left;
 		}
+
+		// publish the new data to the processing task
+		linkProbe.markReceived(queueEnd, receiveTime);
+		base.queueEnd.store(queueEnd, std::memory_order_release);
+		statistics.addReceivedBytes(incomingSize, (queueEnd - base.queueCurrent.load(std::memory_order_relaxed) + MAX_BUFFER) % MAX_BUFFER);
+		PROFILE_END(SERIAL_READ);
 	}
 
+#if defined(FLOW_CONTROL_ENABLED)
+	flowControl.update((queueEnd - base.queueCurrent.load(std::memory_order_relaxed) + MAX_BUFFER) % MAX_BUFFER);
+#endif
+
 #if defined(LED_POWER_PIN)
 	powerControl.update(incomingSize > 0);
 #endif
 
+#if defined(ENABLE_PROFILING)
+	// the processing task prints the requested table when it has the serial read stage
+	if (profiler.handOver())
+		return true;
+#endif
+
 	return (incomingSize > 0);
 }
 
@@ -76,6 +155,17 @@ void updateMainStatistics(unsigned long currentTime, unsigned long deltaTime, bo
 		statistics.lightReset(currentTime, hasData);
 }
 
+/**
+ * @brief Get the free space in the data buffer
+ *
+ * @param queueCurrent processing position
+ * @return int
+ */
+inline int getFreeSpace(int queueCurrent)
+{
+	return MAX_BUFFER - 1 - (base.queueEnd.load(std::memory_order_relaxed) - queueCurrent + MAX_BUFFER) % MAX_BUFFER;
+}
+
 /**
  * @brief process received data on core 0
  *
@@ -86,35 +176,91 @@ void processData()
 	unsigned long currentTime = millis();
 	unsigned long deltaTime = currentTime - statistics.getStartTime();
 
-	updateMainStatistics(currentTime, deltaTime, base.queueCurrent != base.queueEnd);
-
-	if (statistics.getStartTime() + 5000 < millis())
+	// no data for 5 seconds: drop the unfinished frame. Checked before the statistics restart the period
+	// on the new data, otherwise the processing task (woken up only by the new data) would never see the gap.
+	if (statistics.getStartTime() + 5000 < currentTime)
 	{
 		frameState.setState(AwaProtocol::HEADER_A);
 	}
 
+	updateMainStatistics(currentTime, deltaTime, base.queueCurrent != base.queueEnd);
+
+	#if defined(PERSISTENT_LED_CONFIG)
+		persistentConfig.update(currentTime);
+	#endif
+
+	errorStatistics.update(currentTime);
+	telemetry.update(currentTime);
+
+	#if defined(ENABLE_PROFILING)
+		profiler.update();
+	#endif
+
 	// render waiting frame if available
-	if (base.hasLateFrameToRender())
-		base.renderLeds(false);
+	if (base.hasLateFrameToRender() || base.hasQueuedFrames())
+	{
+		if (base.hasLateFrameToRender())
+			base.renderLeds(false);
+		if (base.hasQueuedFrames())
+			base.renderQueuedFrames();
+		frameAck.update(base.hasLateFrameToRender(), getFreeSpace(base.queueCurrent.load(std::memory_order_relaxed)));
+	}
 
 	// process received data
-	while (base.queueCurrent != base.queueEnd)
+	PROFILE_START(DECODE);
+	// only this task writes the queue position, the end is read again when the published data is consumed
+	int queueCurrent = base.queueCurrent.load(std::memory_order_relaxed);
+	int queueEnd = base.queueEnd.load(std::memory_order_acquire);
+	// the loss is recorded before the data after it is published, so it's read once per batch
+	int lossPosition = base.lossPosition.load(std::memory_order_relaxed);
+
+	while (queueCurrent != queueEnd)
 	{
-		byte input = base.buffer[base.queueCurrent++];
+		// the data was lost in the serial driver before this position: abandon the current frame
+		if (queueCurrent == lossPosition)
+		{
+			if (base.lossPosition.compare_exchange_strong(lossPosition, -1, std::memory_order_relaxed))
+				frameState.setState(AwaProtocol::HEADER_A);
+			lossPosition = -1;
+		}
 
-		if (base.queueCurrent >= MAX_BUFFER)
+		byte input = base.buffer[queueCurrent++];
+
+		if (queueCurrent >= MAX_BUFFER)
 		{
-			base.queueCurrent = 0;
+			queueCurrent = 0;
+			base.queueCurrent.store(queueCurrent, std::memory_order_release);
 			yield();
 		}
 
+		// give the consumed space back to the serial task and check for more data
+		if (queueCurrent == queueEnd)
+		{
+			base.queueCurrent.store(queueCurrent, std::memory_order_release);
+			queueEnd = base.queueEnd.load(std::memory_order_acquire);
+			lossPosition = base.lossPosition.load(std::memory_order_relaxed);
+		}
+		else if (queueCurrent % QUEUE_RELEASE_BYTES == 0)
+		{
+			// the long batch: the serial task and the flow control see the free space while it's decoded
+			base.queueCurrent.store(queueCurrent, std::memory_order_release);
+		}
+
 		switch (frameState.getState())
 		{
 		case AwaProtocol::HEADER_A:
 			// assume it's protocol version 1, verify it later
 			frameState.setProtocolVersion2(false);
+			frameState.setRemapFrame(false);
+			frameState.setSequenced(false);
+			frameState.setTimed(false);
 			if (input == 'A')
+			{
+				latency.markFrameStart();
 				frameState.setState(AwaProtocol::HEADER_w);
+			}
+			else
+				statistics.increaseResync();
 			break;
 
 		case AwaProtocol::HEADER_w:
@@ -133,13 +279,34 @@ void processData()
 				frameState.setState(AwaProtocol::HEADER_HI);
 				frameState.setProtocolVersion2(true);
 			}
+			else if (input == 'm')
+			{
+				frameState.setState(AwaProtocol::HEADER_HI);
+				frameState.setRemapFrame(true);
+			}
+			else if (input == 's' || input == 'S')
+			{
+				// protocol version 1/2 with the sequence number
+				frameState.setState(AwaProtocol::HEADER_HI);
+				frameState.setProtocolVersion2(input == 'S');
+				frameState.setSequenced(true);
+			}
+			else if (input == 'p' || input == 'P')
+			{
+				// protocol version 1/2 with the sequence number and the presentation time
+				frameState.setState(AwaProtocol::HEADER_HI);
+				frameState.setProtocolVersion2(input == 'P');
+				frameState.setSequenced(true);
+				frameState.setTimed(true);
+			}
 			else
 				frameState.setState(AwaProtocol::HEADER_A);
 			break;
 
 		case AwaProtocol::HEADER_HI:
 			// initialize new frame properties
-			statistics.increaseTotal();
+			if (!frameState.isRemapFrame())
+				statistics.increaseTotal();
 			frameState.init(input);
 			frameState.setState(AwaProtocol::HEADER_LO);
 			break;
@@ -153,33 +320,116 @@ void processData()
 			// verify CRC and create/update LED driver if neccesery
 			if (frameState.getCRC() == input)
 			{
-				uint16_t ledSize = frameState.getCount() + 1;
+				int ledSize = frameState.getCount() + 1;
 
 				// sanity check
-				if (ledSize > 4096)
+				if (ledSize > MAX_LEDS)
+				{
+					errorStatistics.increase(ErrorType::OVERSIZE);
 					frameState.setState(AwaProtocol::HEADER_A);
+				}
+				else if (frameState.isRemapFrame())
+				{
+					// the remap table upload: one 16-bit physical index per LED
+					if (remapTable.begin(ledSize))
+						frameState.setState(AwaProtocol::REMAP_HI);
+					else
+						frameState.setState(AwaProtocol::HEADER_A);
+				}
 				else
 				{
 					if (ledSize != base.getLedsNumber())
+					{
+						errorStatistics.increase(ErrorType::REINIT);
 						base.initLedStrip(ledSize);
 
-					frameState.setState(AwaProtocol::RED);
+						#if defined(PERSISTENT_LED_CONFIG)
+							persistentConfig.setLedsNumber(ledSize);
+						#endif
+					}
+
+					frameState.setState((frameState.isSequenced()) ? AwaProtocol::SEQUENCE_HI : AwaProtocol::RED);
 				}
 			}
+			else if (frameState.getCount() ==  0x2aa2 && input == 0x65)
+			{
+				// clock synchronization for the presentation time
+				clockSync.reply();
+				frameState.setState(AwaProtocol::HEADER_A);
+			}
+			else if (frameState.getCount() ==  0x2aa2 && input == 0x85)
+			{
+				// round-trip latency probe: answer right away with the receive time and the data buffer occupancy
+				linkProbe.reply(queueCurrent, base.queueEnd.load(std::memory_order_acquire));
+				frameState.setState(AwaProtocol::HEADER_A);
+			}
+			else if (frameState.getCount() ==  0x2aa2 && (input == 0x75 || input == 0x76))
+			{
+				// enable/disable the frame pacing (jitter buffer) of the frames without the presentation time
+				if (input == 0x76)
+					base.dropQueuedFrames();
+				framePacer.setEnabled(input == 0x75);
+				frameState.setState(AwaProtocol::HEADER_A);
+			}
+			else if (frameState.getCount() ==  0x2aa2 && (input == 0x55 || input == 0x56))
+			{
+				// enable/disable live telemetry records
+				telemetry.setEnabled(input == 0x55, currentTime);
+				frameState.setState(AwaProtocol::HEADER_A);
+			}
+			#if defined(ENABLE_PROFILING)
+			else if (frameState.getCount() ==  0x2aa2 && input == 0x45)
+			{
+				profiler.request();
+				frameState.setState(AwaProtocol::HEADER_A);
+			}
+			#endif
 			else if (frameState.getCount() ==  0x2aa2 && (input == 0x15 || input == 0x35))
 			{
 				statistics.print(currentTime, base.processDataHandle, base.processSerialHandle);
+				latency.print();
+				renderScheduler.print((base.getLedStrip2() != nullptr) ? 2 : 1);
+				framePacer.print();
+				errorStatistics.print();
+				#if defined(FLOW_CONTROL_ENABLED)
+					flowControl.print();
+				#endif
 
 				if (input == 0x15)
-					SerialPort.println(HELLO_MESSAGE);
-				delay(10);
+					txQueue.print(HELLO_MESSAGE "\r\n");
 
 				currentTime = millis();
 				statistics.reset(currentTime);
+				latency.reset();
+				framePacer.reset();
 				frameState.setState(AwaProtocol::HEADER_A);
 			}
 			else
+			{
+				errorStatistics.increase(ErrorType::HEADER_CRC);
 				frameState.setState(AwaProtocol::HEADER_A);
+			}
+			break;
+
+		case AwaProtocol::SEQUENCE_HI:
+			frameState.setSequenceHigh(input);
+			frameState.addFletcher(input);
+
+			frameState.setState(AwaProtocol::SEQUENCE_LO);
+			break;
+
+		case AwaProtocol::SEQUENCE_LO:
+			frameState.setSequenceLow(input);
+			frameState.addFletcher(input);
+
+			frameState.setState((frameState.isTimed()) ? AwaProtocol::PRESENTATION_TIME : AwaProtocol::RED);
+			break;
+
+		case AwaProtocol::PRESENTATION_TIME:
+			frameState.addFletcher(input);
+
+			if (frameState.addPresentationByte(input))
+				frameState.setState(AwaProtocol::RED);
 			break;
 
 		case AwaProtocol::RED:
@@ -220,6 +470,23 @@ void processData()
 
 			break;
 
+		case AwaProtocol::REMAP_HI:
+			remapTable.setEntryHigh(input);
+			frameState.addFletcher(input);
+
+			frameState.setState(AwaProtocol::REMAP_LO);
+			break;
+
+		case AwaProtocol::REMAP_LO:
+			frameState.addFletcher(input);
+
+			// set the entry and check if it was the last one to come
+			if (remapTable.setEntryLow(input))
+				frameState.setState(AwaProtocol::REMAP_HI);
+			else
+				frameState.setState(AwaProtocol::FLETCHER1);
+			break;
+
 		case AwaProtocol::VERSION2_GAIN:
 			frameState.calibration.gain = input;
 			frameState.addFletcher(input);
@@ -251,7 +518,10 @@ void processData()
 		case AwaProtocol::FLETCHER1:
 			// initial frame data integrity check
 			if (input != frameState.getFletcher1())
+			{
+				errorStatistics.increase(ErrorType::FLETCHER1);
 				frameState.setState(AwaProtocol::HEADER_A);
+			}
 			else
 				frameState.setState(AwaProtocol::FLETCHER2);
 			break;
@@ -259,24 +529,52 @@ void processData()
 		case AwaProtocol::FLETCHER2:
 			// initial frame data integrity check
 			if (input != frameState.getFletcher2())
+			{
+				errorStatistics.increase(ErrorType::FLETCHER2);
 				frameState.setState(AwaProtocol::HEADER_A);
+			}
 			else
 				frameState.setState(AwaProtocol::FLETCHER_EXT);
 			break;
 
 		case AwaProtocol::FLETCHER_EXT:
 			// final frame data integrity check
-			if (input == frameState.getFletcherExt())
+			if (input == frameState.getFletcherExt() && frameState.isRemapFrame())
+			{
+				// the new layout applies starting with the next frame
+				remapTable.commit();
+			}
+			else if (input == frameState.getFletcherExt())
 			{
 				statistics.increaseGood();
+				latency.markFrameDecoded();
+				base.queueCurrent.store(queueCurrent, std::memory_order_release);
+				frameAck.frameDecoded(frameState.isSequenced(), frameState.getSequence());
 
-				base.renderLeds(true);
+				if (frameState.isTimed())
+				{
+					if (base.presentFrame(frameState.getPresentationTime(), frameState.isSequenced(), frameState.getSequence()))
+						frameAck.frameQueued();
+				}
+				else if (framePacer.isEnabled())
+				{
+					if (base.presentFrame(framePacer.schedule(micros(), frameQueue.getCount()), frameState.isSequenced(), frameState.getSequence()))
+						frameAck.frameQueued();
+				}
+				else
+					base.renderLeds(true);
+				frameAck.update(base.hasLateFrameToRender(), getFreeSpace(queueCurrent));
 
 				#ifdef NEOPIXEL_RGBW
 					// if received the calibration data, update it now
 					if (frameState.isProtocolVersion2())
 					{
 						frameState.updateIncomingCalibration();
+
+						#if defined(PERSISTENT_LED_CONFIG)
+							persistentConfig.setCalibration(frameState.calibration.gain, frameState.calibration.red,
+															frameState.calibration.green, frameState.calibration.blue);
+						#endif
 					}
 				#endif
 
@@ -286,11 +584,14 @@ void processData()
 
 				yield();
 			}
+			else
+				errorStatistics.increase(ErrorType::FLETCHER_EXT);
 
 			frameState.setState(AwaProtocol::HEADER_A);
 			break;
 		}
 	}
+	PROFILE_END(DECODE);
 }
 
 #endif
\ No newline at end of file
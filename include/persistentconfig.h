@@ -0,0 +1,202 @@
+/* persistentconfig.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef PERSISTENTCONFIG_H
+#define PERSISTENTCONFIG_H
+
+#include <Preferences.h>
+
+#if defined(SECOND_SEGMENT_START_INDEX)
+	#define PERSISTENT_SEGMENT_INDEX SECOND_SEGMENT_START_INDEX
+#else
+	#define PERSISTENT_SEGMENT_INDEX 0
+#endif
+
+#if defined(SECOND_SEGMENT_REVERSED)
+	#define PERSISTENT_SEGMENT_REVERSED 1
+#else
+	#define PERSISTENT_SEGMENT_REVERSED 0
+#endif
+
+/**
+ * @brief Keeps the last LED configuration in NVS, so the LED strip can be set up at boot before the first frame
+ *
+ */
+class
+{
+	// minimum time between NVS writes to save the flash
+	const unsigned long SAVE_PERIOD = 60 * 1000;
+
+	// configuration must be stable for that time before it's written
+	const unsigned long SAVE_DELAY = 10 * 1000;
+
+	// increase it when the layout of the structure below changes
+	const uint16_t CONFIG_VERSION = 1;
+
+	struct StoredConfig
+	{
+		uint16_t version = 0;
+		uint16_t segmentIndex = 0;
+		uint8_t segmentReversed = 0;
+		uint8_t gain = 0;
+		uint8_t red = 0;
+		uint8_t green = 0;
+		uint8_t blue = 0;
+		uint8_t hasCalibration = 0;
+		uint32_t ledsNumber = 0;
+
+		// compared field by field: the padding bytes are not initialized
+		bool operator==(const StoredConfig& other) const
+		{
+			return version == other.version && segmentIndex == other.segmentIndex && segmentReversed == other.segmentReversed &&
+				gain == other.gain && red == other.red && green == other.green && blue == other.blue &&
+				hasCalibration == other.hasCalibration && ledsNumber == other.ledsNumber;
+		}
+	};
+
+	Preferences preferences;
+	StoredConfig saved;
+	StoredConfig current;
+	bool pending = false;
+	unsigned long lastChangeTimestamp = 0;
+	unsigned long lastSaveTimestamp = 0;
+
+	inline void markChanged()
+	{
+		pending = !(current == saved);
+		lastChangeTimestamp = millis();
+	}
+
+	public:
+		/**
+		 * @brief Read the stored configuration
+		 *
+		 * @return true if it's valid for the current firmware layout
+		 */
+		bool load()
+		{
+			preferences.begin("hyperserial", false);
+
+			if (preferences.getBytes("config", &saved, sizeof(StoredConfig)) != sizeof(StoredConfig) ||
+				saved.version != CONFIG_VERSION ||
+				saved.segmentIndex != PERSISTENT_SEGMENT_INDEX ||
+				saved.segmentReversed != PERSISTENT_SEGMENT_REVERSED ||
+				saved.ledsNumber == 0 || saved.ledsNumber > MAX_LEDS)
+			{
+				saved = StoredConfig();
+				current = saved;
+				return false;
+			}
+
+			current = saved;
+			return true;
+		}
+
+		inline int getLedsNumber()
+		{
+			return saved.ledsNumber;
+		}
+
+		inline bool hasCalibration()
+		{
+			return saved.hasCalibration != 0;
+		}
+
+		inline uint8_t getGain()
+		{
+			return saved.gain;
+		}
+
+		inline uint8_t getRed()
+		{
+			return saved.red;
+		}
+
+		inline uint8_t getGreen()
+		{
+			return saved.green;
+		}
+
+		inline uint8_t getBlue()
+		{
+			return saved.blue;
+		}
+
+		/**
+		 * @brief New LED count was received from the host
+		 *
+		 * @param ledsNumber
+		 */
+		void setLedsNumber(int ledsNumber)
+		{
+			current.ledsNumber = ledsNumber;
+			markChanged();
+		}
+
+		/**
+		 * @brief New RGBW calibration was received from the host
+		 *
+		 */
+		void setCalibration(uint8_t gain, uint8_t red, uint8_t green, uint8_t blue)
+		{
+			if (!current.hasCalibration || current.gain != gain || current.red != red || current.green != green || current.blue != blue)
+			{
+				current.hasCalibration = 1;
+				current.gain = gain;
+				current.red = red;
+				current.green = green;
+				current.blue = blue;
+				markChanged();
+			}
+		}
+
+		/**
+		 * @brief Write the configuration if it's changed, stable and the write limit allows it
+		 *
+		 * @param currentTime
+		 */
+		void update(unsigned long currentTime)
+		{
+			if (pending &&
+				currentTime - lastChangeTimestamp >= SAVE_DELAY &&
+				(lastSaveTimestamp == 0 || currentTime - lastSaveTimestamp >= SAVE_PERIOD))
+			{
+				current.version = CONFIG_VERSION;
+				current.segmentIndex = PERSISTENT_SEGMENT_INDEX;
+				current.segmentReversed = PERSISTENT_SEGMENT_REVERSED;
+
+				preferences.putBytes("config", &current, sizeof(StoredConfig));
+
+				saved = current;
+				pending = false;
+				lastSaveTimestamp = currentTime;
+			}
+		}
+
+} persistentConfig;
+
+#endif
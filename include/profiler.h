@@ -0,0 +1,156 @@
+/* profiler.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+
+/**
+ * @brief Stages of the decode pipeline measured by the profiler
+ *
+ */
+enum class ProfilerStage
+{
+	SERIAL_READ,
+	DECODE,
+	FLETCHER,
+	RGB2RGBW,
+	SET_PIXEL,
+	SHOW,
+	COUNT
+};
+
+#if defined(ENABLE_PROFILING)
+
+	#define PROFILE_START(stage) uint32_t _profileStart##stage = ESP.getCycleCount()
+	#define PROFILE_END(stage) profiler.add(ProfilerStage::stage, ESP.getCycleCount() - _profileStart##stage)
+
+	/**
+	 * @brief CPU cycles and call counts accumulated per stage.
+	 * The serial read stage is updated by the serial task, all the others by the processing task, which also prints
+	 * and resets the table. The serial task keeps its stage to itself and hands it over when the table is requested.
+	 *
+	 */
+	class
+	{
+		enum { HANDOFF_IDLE, HANDOFF_REQUESTED, HANDOFF_READY };
+
+		struct Stage
+		{
+			uint64_t cycles;
+			uint32_t calls;
+		};
+
+		// the stages of the processing task
+		Stage stages[(int)ProfilerStage::COUNT] = {};
+		// the serial read stage, only the serial task uses it
+		Stage serialStage = {};
+		// the serial read stage moved out by the serial task, read by the processing task when the handoff is ready
+		Stage serialReport = {};
+		std::atomic<int> handoff{HANDOFF_IDLE};
+
+		/**
+		 * @brief Print the table and reset it. The decode stage includes the nested stages.
+		 *
+		 */
+		void print()
+		{
+			const char* names[] = { "serial read", "decode", "fletcher", "rgb2rgbw", "set pixel", "show" };
+			char output[128];
+
+			stages[(int)ProfilerStage::SERIAL_READ] = serialReport;
+
+			for (int i = 0; i < (int)ProfilerStage::COUNT; i++)
+			{
+				snprintf(output, sizeof(output), "Profile %s: calls: %u, cycles: %llu, avg: %u\r\n", names[i],
+							(unsigned int)stages[i].calls, (unsigned long long)stages[i].cycles,
+							(unsigned int)((stages[i].calls > 0) ? stages[i].cycles / stages[i].calls : 0));
+				txQueue.print(output);
+			}
+
+			memset(stages, 0, sizeof(stages));
+		}
+
+		public:
+			inline void add(ProfilerStage stage, uint32_t cycles)
+			{
+				Stage& target = (stage == ProfilerStage::SERIAL_READ) ? serialStage : stages[(int)stage];
+
+				target.cycles += cycles;
+				target.calls++;
+			}
+
+			/**
+			 * @brief Ask for the table (processing task), it's printed by update() after the serial task hands over its stage
+			 *
+			 */
+			void request()
+			{
+				int idle = HANDOFF_IDLE;
+
+				handoff.compare_exchange_strong(idle, HANDOFF_REQUESTED, std::memory_order_release);
+			}
+
+			/**
+			 * @brief Move the serial read stage to the processing task if it was requested (serial task)
+			 *
+			 * @return true if the processing task should be woken up to print the table
+			 */
+			inline bool handOver()
+			{
+				if (handoff.load(std::memory_order_acquire) != HANDOFF_REQUESTED)
+					return false;
+
+				serialReport = serialStage;
+				serialStage = {};
+				handoff.store(HANDOFF_READY, std::memory_order_release);
+				return true;
+			}
+
+			/**
+			 * @brief Print the requested table when the serial read stage is handed over (processing task)
+			 *
+			 */
+			void update()
+			{
+				if (handoff.load(std::memory_order_acquire) == HANDOFF_READY)
+				{
+					print();
+					handoff.store(HANDOFF_IDLE, std::memory_order_relaxed);
+				}
+			}
+	} profiler;
+
+#else
+
+	#define PROFILE_START(stage)
+	#define PROFILE_END(stage)
+
+#endif
+
+#endif
@@ -0,0 +1,126 @@
+/* remaptable.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef REMAPTABLE_H
+#define REMAPTABLE_H
+
+/**
+ * @brief Per-LED index remap table uploaded by the host (serpentine matrices, arbitrary layouts)
+ *
+ */
+class
+{
+	// active table: logical LED index => physical LED index
+	uint16_t* table = nullptr;
+	uint16_t tableSize = 0;
+	uint16_t tableCapacity = 0;
+	// table being received, becomes active after the checksum is verified
+	uint16_t* staging = nullptr;
+	uint16_t stagingSize = 0;
+	uint16_t stagingCapacity = 0;
+	uint16_t stagingIndex = 0;
+
+	public:
+		/**
+		 * @brief Prepare the staging table for the incoming remap frame
+		 *
+		 * @param size
+		 * @return true
+		 * @return false if the memory could not be allocated
+		 */
+		bool begin(uint16_t size)
+		{
+			if (size > stagingCapacity)
+			{
+				free(staging);
+				staging = (uint16_t*)malloc(size * sizeof(uint16_t));
+				stagingCapacity = (staging != nullptr) ? size : 0;
+			}
+
+			stagingSize = (staging != nullptr) ? size : 0;
+			stagingIndex = 0;
+
+			return (staging != nullptr);
+		}
+
+		/**
+		 * @brief Set the high byte of the current staging entry
+		 *
+		 * @param input
+		 */
+		inline void setEntryHigh(uint8_t input)
+		{
+			staging[stagingIndex] = input << 8;
+		}
+
+		/**
+		 * @brief Set the low byte of the current staging entry and move to the next one
+		 *
+		 * @param input
+		 * @return true if more entries are expected
+		 */
+		inline bool setEntryLow(uint8_t input)
+		{
+			staging[stagingIndex++] |= input;
+			return (stagingIndex < stagingSize);
+		}
+
+		/**
+		 * @brief Activate the received table (checksum is verified), the previous one is reused for the next upload
+		 *
+		 */
+		void commit()
+		{
+			std::swap(table, staging);
+			std::swap(tableCapacity, stagingCapacity);
+			tableSize = stagingSize;
+			stagingSize = 0;
+		}
+
+		/**
+		 * @brief Get the current table size (0 = identity mapping)
+		 *
+		 * @return uint16_t
+		 */
+		inline uint16_t getSize()
+		{
+			return tableSize;
+		}
+
+		/**
+		 * @brief Translate the logical LED index to the physical one
+		 *
+		 * @param pix
+		 * @return uint16_t
+		 */
+		inline uint16_t map(uint16_t pix)
+		{
+			return (pix < tableSize) ? table[pix] : pix;
+		}
+} remapTable;
+
+#endif
@@ -0,0 +1,222 @@
+/* renderscheduler.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef RENDERSCHEDULER_H
+#define RENDERSCHEDULER_H
+
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+
+#if !defined(RENDER_RETRY_US)
+	#define RENDER_RETRY_US 100
+#endif
+
+/**
+ * @brief Measures Show() duration and the bus busy time (Show() => CanShow()) of every LED segment.
+ * When a frame waits for the bus, a one-shot timer wakes the processing task at the predicted moment
+ * the bus frees up, so the late frame doesn't have to wait for the next serial data.
+ * The same timer wakes it at the presentation time of the queued frame (the earlier of both moments).
+ *
+ */
+class
+{
+	enum { SEGMENTS = 2 };
+
+	struct SegmentTiming
+	{
+		// CPU time spent in Show() (us, moving average)
+		uint32_t showTime;
+		// predicted time from Show() start to CanShow() (us)
+		uint32_t busyTime;
+		// start of the last Show() (us)
+		unsigned long showStart;
+		// the segment wasn't seen ready since the last Show()
+		bool busy;
+		// longest time from Show() start the segment was seen busy (us, 0 = not yet)
+		uint32_t busySeen;
+	} segment[SEGMENTS] = {};
+
+	esp_timer_handle_t timer = nullptr;
+	// the armed wake-up (micros())
+	unsigned long wakeTime = 0;
+	bool wakeArmed = false;
+
+	static void onTimer(void* parameters)
+	{
+		xSemaphoreGive((xSemaphoreHandle)parameters);
+	}
+
+	/**
+	 * @brief Arm the timer unless it's already armed for an earlier moment
+	 *
+	 * @param now micros()
+	 * @param delay us
+	 */
+	void arm(unsigned long now, uint32_t delay)
+	{
+		if (wakeArmed && (int32_t)(wakeTime - now) > 0 && (int32_t)(wakeTime - now - delay) <= 0)
+			return;
+
+		wakeTime = now + delay;
+		wakeArmed = true;
+		esp_timer_stop(timer);
+		esp_timer_start_once(timer, delay);
+	}
+
+	public:
+		/**
+		 * @brief Create the wake-up timer (multicore mode only, the single core loop polls anyway)
+		 *
+		 * @param semaphore wakes the processing task
+		 */
+		void begin(xSemaphoreHandle semaphore)
+		{
+			esp_timer_create_args_t args = {};
+
+			args.callback = onTimer;
+			args.arg = semaphore;
+			args.name = "render";
+			if (esp_timer_create(&args, &timer) != ESP_OK)
+				timer = nullptr;
+		}
+
+		/**
+		 * @brief The segment was sent to the bus
+		 *
+		 * @param index segment
+		 * @param showStart micros() before Show()
+		 * @param showEnd micros() after Show()
+		 */
+		inline void markShow(int index, unsigned long showStart, unsigned long showEnd)
+		{
+			SegmentTiming& seg = segment[index];
+			uint32_t duration = showEnd - showStart;
+
+			seg.showTime = (seg.showTime == 0) ? duration : (seg.showTime * 7 + duration) / 8;
+			seg.showStart = showStart;
+			seg.busy = true;
+			seg.busySeen = 0;
+		}
+
+		/**
+		 * @brief Record the CanShow() result of the segment and refine the predicted busy time.
+		 * The segment seen busy past the prediction means it was too short: the first successful probe becomes the new one.
+		 * A prediction confirmed by the probe is kept, so the wake-up latency of the timer doesn't accumulate in it.
+		 * Without any busy observation the prediction shrinks slowly, so it follows the real transfer time from above.
+		 *
+		 * @param index segment
+		 * @param canShow
+		 * @return bool canShow
+		 */
+		inline bool probe(int index, bool canShow)
+		{
+			SegmentTiming& seg = segment[index];
+
+			if (seg.busy)
+			{
+				uint32_t elapsed = micros() - seg.showStart;
+
+				if (!canShow)
+					seg.busySeen = max(seg.busySeen, elapsed);
+				else
+				{
+					if (seg.busyTime == 0 || seg.busySeen >= seg.busyTime)
+						seg.busyTime = elapsed;
+					else if (seg.busySeen > 0)
+						seg.busyTime = min(elapsed, seg.busyTime);
+					else
+						seg.busyTime = min(elapsed, seg.busyTime - seg.busyTime / 16);
+					seg.busy = false;
+				}
+			}
+
+			return canShow;
+		}
+
+		/**
+		 * @brief A frame is waiting for the bus: wake the processing task when the busiest segment is predicted to be free
+		 *
+		 */
+		void schedule()
+		{
+			if (timer == nullptr)
+				return;
+
+			unsigned long now = micros();
+			uint32_t delay = RENDER_RETRY_US;
+
+			for (int i = 0; i < SEGMENTS; i++)
+			{
+				SegmentTiming& seg = segment[i];
+
+				if (seg.busy)
+				{
+					int32_t left = (int32_t)(seg.showStart + seg.busyTime - now);
+					if (left > (int32_t)delay)
+						delay = left;
+				}
+			}
+
+			arm(now, delay);
+		}
+
+		/**
+		 * @brief A queued frame waits for its presentation time: wake the processing task then
+		 *
+		 * @param time micros()
+		 */
+		void wakeAt(unsigned long time)
+		{
+			if (timer == nullptr)
+				return;
+
+			unsigned long now = micros();
+			int32_t left = (int32_t)(time - now);
+
+			arm(now, (left > 0) ? left : 0);
+		}
+
+		/**
+		 * @brief Print Show() and bus timing of the segments
+		 *
+		 * @param segments number of the active segments
+		 */
+		void print(int segments)
+		{
+			char output[128];
+
+			for (int i = 0; i < segments && i < SEGMENTS; i++)
+			{
+				snprintf(output, sizeof(output), "Segment %i: Show() %u us, CanShow() wait %u us\r\n", i + 1,
+							(unsigned int)segment[i].showTime,
+							(unsigned int)((segment[i].busyTime > segment[i].showTime) ? segment[i].busyTime - segment[i].showTime : 0));
+				txQueue.print(output);
+			}
+		}
+} renderScheduler;
+
+#endif
@@ -28,6 +28,8 @@
 #ifndef STATISTICS_H
 #define STATISTICS_H
 
+#include <atomic>
+
 // statistics (stats sent only when there is no communication)
 class
 {
@@ -38,8 +40,23 @@ class
 	uint16_t finalGoodFrames = 0;
 	uint16_t finalShowFrames = 0;
 	uint16_t finalTotalFrames = 0;
+	// boot timing (microseconds since reset)
+	unsigned long readyTime = 0;
+	std::atomic<unsigned long> firstByteTime{0};
 
 	public:
+		// lifetime counters, never reset (receivedBytes and ringHighWater are updated by the serial task)
+		struct
+		{
+			uint32_t goodFrames = 0;
+			uint32_t showFrames = 0;
+			uint32_t lateFrames = 0;
+			uint32_t totalFrames = 0;
+			uint32_t resyncBytes = 0;
+			std::atomic<uint32_t> receivedBytes{0};
+			std::atomic<uint32_t> ringHighWater{0};
+		} lifetime;
+
 		/**
 		 * @brief Get the start time of the current period
 		 *
@@ -57,6 +74,7 @@ class
 		inline void increaseTotal()
 		{
 			totalFrames++;
+			lifetime.totalFrames++;
 		}
 
 		/**
@@ -66,6 +84,7 @@ class
 		inline void increaseShow()
 		{
 			showFrames++;
+			lifetime.showFrames++;
 		}
 
 		/**
@@ -75,6 +94,59 @@ class
 		inline void increaseGood()
 		{
 			goodFrames++;
+			lifetime.goodFrames++;
+		}
+
+		/**
+		 * @brief The frame could not be shown immediately (LED strip is busy)
+		 *
+		 */
+		inline void increaseLate()
+		{
+			lifetime.lateFrames++;
+		}
+
+		/**
+		 * @brief The byte was skipped while searching for the frame header
+		 *
+		 */
+		inline void increaseResync()
+		{
+			lifetime.resyncBytes++;
+		}
+
+		/**
+		 * @brief New data was read to the buffer (serial task)
+		 *
+		 * @param size
+		 * @param occupancy buffer usage after reading
+		 */
+		inline void addReceivedBytes(int size, int occupancy)
+		{
+			lifetime.receivedBytes.fetch_add(size, std::memory_order_relaxed);
+			if ((uint32_t)occupancy > lifetime.ringHighWater.load(std::memory_order_relaxed))
+				lifetime.ringHighWater.store(occupancy, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief The device is ready to accept the data (tasks are started)
+		 *
+		 * @param curTime
+		 */
+		inline void setReadyTime(unsigned long curTime)
+		{
+			readyTime = curTime;
+		}
+
+		/**
+		 * @brief Save the time of the first accepted byte after the reset
+		 *
+		 * @param curTime
+		 */
+		inline void setFirstByteTime(unsigned long curTime)
+		{
+			if (firstByteTime.load(std::memory_order_relaxed) == 0)
+				firstByteTime.store(curTime, std::memory_order_relaxed);
 		}
 
 		/**
@@ -108,7 +180,7 @@ class
 		}
 
 		/**
-		 * @brief Print last saved statistics to the serial port
+		 * @brief Queue last saved statistics for the serial port
 		 *
 		 * @param curTime
 		 * @param taskHandle
@@ -127,7 +199,13 @@ class
 						(taskHandle1 != nullptr) ? uxTaskGetStackHighWaterMark(taskHandle1) : 0,
 						(taskHandle2 != nullptr) ? uxTaskGetStackHighWaterMark(taskHandle2) : 0,
 						ESP.getFreeHeap());
-			SerialPort.print(output);
+			txQueue.print(output);
+
+			snprintf(output, sizeof(output), "Buffer: size: %i, high-water: %u\r\n", MAX_BUFFER, (unsigned int)lifetime.ringHighWater);
+			txQueue.print(output);
+
+			snprintf(output, sizeof(output), "Boot: ready after %lu us, first byte after %lu us\r\n", readyTime, firstByteTime.load());
+			txQueue.print(output);
 
 			#if defined(NEOPIXEL_RGBW)
 				calibrationConfig.printCalibration();
@@ -0,0 +1,121 @@
+/* telemetry.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#if !defined(TELEMETRY_INTERVAL)
+	#define TELEMETRY_INTERVAL 250
+#endif
+
+#define TELEMETRY_RECORD_TYPE 'T'
+
+/**
+ * @brief Telemetry record (little-endian), sent every TELEMETRY_INTERVAL ms while it's enabled
+ *
+ */
+struct __attribute__((packed)) TelemetryRecord
+{
+	uint32_t timestamp;			// ms since boot
+	uint16_t interval;			// ms since the previous record
+	uint16_t goodFrames;		// correctly received frames in the interval
+	uint16_t showFrames;		// shown frames in the interval
+	uint16_t lateFrames;		// frames that had to wait for the LED strip in the interval
+	uint16_t checksumErrors;	// frames with the checksum error in the interval
+	uint32_t bytesPerSecond;	// received data rate
+	uint32_t resyncBytes;		// bytes skipped while searching for the header in the interval
+	uint32_t ringHighWater;		// highest buffer usage since boot
+};
+
+/**
+ * @brief Live binary statistics interleaved with the outgoing data, enabled by the host
+ *
+ */
+class
+{
+	bool enabled = false;
+	unsigned long lastTime = 0;
+	// lifetime counters at the time of the previous record
+	uint32_t goodFrames = 0;
+	uint32_t showFrames = 0;
+	uint32_t lateFrames = 0;
+	uint32_t checksumErrors = 0;
+	uint32_t resyncBytes = 0;
+	uint32_t receivedBytes = 0;
+
+	public:
+		/**
+		 * @brief Enable or disable the telemetry records
+		 *
+		 * @param newEnabled
+		 * @param currentTime
+		 */
+		void setEnabled(bool newEnabled, unsigned long currentTime)
+		{
+			enabled = newEnabled;
+			lastTime = currentTime;
+			goodFrames = statistics.lifetime.goodFrames;
+			showFrames = statistics.lifetime.showFrames;
+			lateFrames = statistics.lifetime.lateFrames;
+			checksumErrors = errorStatistics.getChecksumErrors();
+			resyncBytes = statistics.lifetime.resyncBytes;
+			receivedBytes = statistics.lifetime.receivedBytes;
+		}
+
+		/**
+		 * @brief Queue the record if the interval elapsed, it never waits for the serial port
+		 *
+		 * @param currentTime
+		 */
+		void update(unsigned long currentTime)
+		{
+			unsigned long interval = currentTime - lastTime;
+
+			if (!enabled || interval < TELEMETRY_INTERVAL)
+				return;
+
+			TelemetryRecord record;
+			uint32_t received = statistics.lifetime.receivedBytes;
+
+			record.timestamp = currentTime;
+			record.interval = std::min(interval, 0xFFFFUL);
+			record.goodFrames = statistics.lifetime.goodFrames - goodFrames;
+			record.showFrames = statistics.lifetime.showFrames - showFrames;
+			record.lateFrames = statistics.lifetime.lateFrames - lateFrames;
+			record.checksumErrors = errorStatistics.getChecksumErrors() - checksumErrors;
+			record.bytesPerSecond = (uint64_t)(received - receivedBytes) * 1000 / interval;
+			record.resyncBytes = statistics.lifetime.resyncBytes - resyncBytes;
+			record.ringHighWater = statistics.lifetime.ringHighWater;
+
+			txQueue.writeRecord(TELEMETRY_RECORD_TYPE, &record, sizeof(record));
+
+			setEnabled(true, currentTime);
+			receivedBytes = received;
+		}
+} telemetry;
+
+#endif
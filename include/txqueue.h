@@ -0,0 +1,203 @@
+/* txqueue.h
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#ifndef TXQUEUE_H
+#define TXQUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <string.h>
+
+#if !defined(TX_QUEUE_SIZE)
+	#define TX_QUEUE_SIZE 2048
+#endif
+
+#define RECORD_ESCAPE 0x7D
+
+/**
+ * @brief Lock-free single producer/single consumer queue for the device-to-host output.
+ * The producer never waits: data that doesn't fit is dropped. The consumer sends only what the port accepts without blocking.
+ *
+ */
+class
+{
+	uint8_t buffer[TX_QUEUE_SIZE];
+	// next byte to send (consumer)
+	std::atomic<size_t> head{0};
+	// next free byte (producer)
+	std::atomic<size_t> tail{0};
+
+	/**
+	 * @brief Append the byte of the binary record, escaped with FLOW_CONTROL_XONXOFF if it could look like XON/XOFF
+	 *
+	 * @param record
+	 * @param length
+	 * @param value
+	 */
+	static inline void putRecordByte(uint8_t* record, size_t& length, uint8_t value)
+	{
+		#if defined(FLOW_CONTROL_XONXOFF)
+			if (value == 0x11 || value == 0x13 || value == RECORD_ESCAPE)
+			{
+				record[length++] = RECORD_ESCAPE;
+				value ^= 0x20;
+			}
+		#endif
+		record[length++] = value;
+	}
+
+	public:
+		/**
+		 * @brief Get the free space in the queue
+		 *
+		 * @return size_t
+		 */
+		inline size_t getFree()
+		{
+			return (head.load(std::memory_order_acquire) + TX_QUEUE_SIZE - tail.load(std::memory_order_relaxed) - 1) % TX_QUEUE_SIZE;
+		}
+
+		/**
+		 * @brief Check if there is nothing to send
+		 *
+		 * @return true
+		 * @return false
+		 */
+		inline bool isEmpty()
+		{
+			return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+		}
+
+		/**
+		 * @brief Put the whole message in the queue or drop it if there is no space
+		 *
+		 * @param data
+		 * @param size
+		 * @return true if the message was queued
+		 */
+		bool write(const uint8_t* data, size_t size)
+		{
+			if (size == 0 || size > getFree())
+				return false;
+
+			size_t end = tail.load(std::memory_order_relaxed);
+			size_t first = std::min(size, (size_t)TX_QUEUE_SIZE - end);
+
+			memcpy(&(buffer[end]), data, first);
+			memcpy(&(buffer[0]), data + first, size - first);
+
+			// publish the message to the consumer
+			tail.store((end + size) % TX_QUEUE_SIZE, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * @brief Put the binary record in the queue: 0xA5 0x5A, type, payload size, payload, xor of the payload bytes.
+		 * With FLOW_CONTROL_XONXOFF the bytes after 0xA5 0x5A that equal XON (0x11), XOFF (0x13) or RECORD_ESCAPE (0x7D)
+		 * are sent as RECORD_ESCAPE followed by the byte XOR 0x20, so the host port never takes them as the flow control.
+		 *
+		 * @param type
+		 * @param payload
+		 * @param size up to 64 bytes
+		 * @return true if the record was queued
+		 */
+		bool writeRecord(uint8_t type, const void* payload, uint8_t size)
+		{
+			// the worst case: every byte after the start is escaped
+			uint8_t record[2 + (64 + 3) * 2];
+			const uint8_t* data = (const uint8_t*)payload;
+			uint8_t checksum = 0;
+			size_t length = 2;
+
+			if (size > 64)
+				return false;
+
+			record[0] = 0xA5;
+			record[1] = 0x5A;
+			putRecordByte(record, length, type);
+			putRecordByte(record, length, size);
+
+			for (int i = 0; i < size; i++)
+			{
+				checksum ^= data[i];
+				putRecordByte(record, length, data[i]);
+			}
+			putRecordByte(record, length, checksum);
+
+			return write(record, length);
+		}
+
+		/**
+		 * @brief Put the text in the queue
+		 *
+		 * @param text
+		 * @return true if the text was queued
+		 */
+		inline bool print(const char* text)
+		{
+			return write((const uint8_t*)text, strlen(text));
+		}
+
+		/**
+		 * @brief Send as much as the port can accept without blocking
+		 *
+		 * @param port
+		 */
+		template <typename T>
+		void drain(T& port)
+		{
+			size_t start = head.load(std::memory_order_relaxed);
+			size_t end = tail.load(std::memory_order_acquire);
+
+			if (start == end)
+				return;
+
+			size_t available = port.availableForWrite();
+			size_t size = std::min((end > start) ? end - start : TX_QUEUE_SIZE - start, available);
+
+			if (size > 0)
+			{
+				port.write(&(buffer[start]), size);
+				// the sent bytes can be reused by the producer
+				head.store((start + size) % TX_QUEUE_SIZE, std::memory_order_release);
+			}
+		}
+
+		/**
+		 * @brief Send everything waiting in the queue (blocking)
+		 *
+		 * @param port
+		 */
+		template <typename T>
+		void flush(T& port)
+		{
+			while (!isEmpty())
+				drain(port);
+		}
+} txQueue;
+
+#endif
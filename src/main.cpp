@@ -58,6 +58,19 @@
 	#pragma message(VAR_NAME_VALUE(SPILED_WS2801))
 #endif
 #pragma message(VAR_NAME_VALUE(SERIALCOM_SPEED))
+#ifdef MAX_LEDS
+	#pragma message(VAR_NAME_VALUE(MAX_LEDS))
+#endif
+#ifdef MAX_BUFFER
+	#pragma message(VAR_NAME_VALUE(MAX_BUFFER))
+#endif
+#ifdef USE_PSRAM
+	#pragma message(VAR_NAME_VALUE(USE_PSRAM))
+#endif
+#ifdef PREALLOCATE_LED_STRIPS
+	#pragma message(VAR_NAME_VALUE(PREALLOCATE_LED_STRIPS))
+	#pragma message(VAR_NAME_VALUE(PREALLOCATE_MAX_LEDS))
+#endif
 
 #if defined(ARDUINO_LOLIN_S2_MINI)
 	#ifdef NEOPIXEL_RGBW
@@ -155,6 +168,9 @@
 		public:
 		bool CanShow() {return true;}
 		void Show(bool safe) {}
+		uint8_t* Pixels() {return nullptr;}
+		size_t PixelsSize() {return 0;}
+		void Dirty() {}
 	};
 #endif
 
@@ -168,6 +184,26 @@
 	#include "powercontrol.h"
 #endif
 
+#ifdef PERSISTENT_LED_CONFIG
+	#pragma message(VAR_NAME_VALUE(PERSISTENT_LED_CONFIG))
+#endif
+
+#ifdef FAST_BOOT
+	#pragma message(VAR_NAME_VALUE(FAST_BOOT))
+#endif
+
+#if defined(FLOW_CONTROL_RTS_PIN) && defined(FLOW_CONTROL_XONXOFF)
+	#error "Choose one flow control: FLOW_CONTROL_RTS_PIN or FLOW_CONTROL_XONXOFF"
+#elif defined(FLOW_CONTROL_RTS_PIN)
+	#pragma message(VAR_NAME_VALUE(FLOW_CONTROL_RTS_PIN))
+#elif defined(FLOW_CONTROL_XONXOFF)
+	#pragma message(VAR_NAME_VALUE(FLOW_CONTROL_XONXOFF))
+#endif
+
+#ifdef FRAME_PACING
+	#pragma message(VAR_NAME_VALUE(FRAME_PACING))
+#endif
+
 
 
 #include "main.h"
@@ -187,12 +223,29 @@ void processDataTask(void * parameters)
 	}
 }
 
+#if !ARDUINO_USB_CDC_ON_BOOT
+	/**
+	 * @brief the serial driver lost the incoming data, the processing task will drop the broken frame
+	 *
+	 * @param error
+	 */
+	void onSerialError(hardwareSerial_error_t error)
+	{
+		if (error == UART_FIFO_OVF_ERROR || error == UART_BUFFER_FULL_ERROR)
+		{
+			errorStatistics.increase((error == UART_FIFO_OVF_ERROR) ? ErrorType::UART_FIFO_OVERFLOW : ErrorType::UART_BUFFER_FULL);
+			base.dataLost = true;
+		}
+	}
+#endif
+
 void processSerialTask(void * parameters)
 {
 	for(;;)
 	{
 		if (serialTaskHandler() || base.queueCurrent != base.queueEnd)
 			xSemaphoreGive(base.i2sXSemaphore);
+		txQueue.drain(SerialPort);
 		yield();
 	}
 }
@@ -201,11 +254,33 @@ void setup()
 {
 	bool multicore = true;
 
+	#if defined(USE_PSRAM)
+		bool buffersReady = base.initBuffers();
+	#endif
+
 	// Init serial port
 	Serial.setRxBufferSize(MAX_BUFFER - 1);
 	Serial.setTimeout(50);
 	Serial.begin(SERIALCOM_SPEED);
-	while (!Serial) continue;
+	#if !ARDUINO_USB_CDC_ON_BOOT
+		Serial.onReceiveError(onSerialError);
+	#endif
+
+	#if defined(USE_PSRAM)
+		// the tasks can't run without the data buffer: keep reporting it instead of crashing on the first read
+		if (!buffersReady)
+			for(;;)
+			{
+				Serial.println("Cannot allocate the data buffer, decrease MAX_BUFFER");
+				delay(1000);
+			}
+	#endif
+	#if !defined(FAST_BOOT)
+		while (!Serial) continue;
+	#endif
+	#if defined(FLOW_CONTROL_ENABLED)
+		flowControl.init();
+	#endif
 
 	#if defined(NEOPIXEL_RGBW) || defined(NEOPIXEL_RGB)
 		#ifdef NEOPIXEL_RGBW
@@ -217,39 +292,69 @@ void setup()
 		#endif
 	#endif
 
+	#if defined(PREALLOCATE_LED_STRIPS)
+		base.reserveLedStrips();
+	#endif
+
+	// restore the last LED configuration, so the first frame doesn't have to set up the LED strip
+	#if defined(PERSISTENT_LED_CONFIG)
+		if (persistentConfig.load())
+		{
+			#ifdef NEOPIXEL_RGBW
+				if (persistentConfig.hasCalibration())
+					calibrationConfig.setParamsAndPrepareCalibration(persistentConfig.getGain(), persistentConfig.getRed(),
+																	persistentConfig.getGreen(), persistentConfig.getBlue());
+			#endif
+			base.initLedStrip(persistentConfig.getLedsNumber());
+		}
+	#endif
+
 	#if !defined(CONFIG_IDF_TARGET_ESP32S2)
-		// Display config
-		Serial.println(HELLO_MESSAGE);
+		// Display config (in the fast boot mode it's sent later by the serial task)
+		#if defined(NEOPIXEL_RGBW) || defined(USE_PSRAM)
+			char output[128];
+		#endif
+
+		txQueue.print(HELLO_MESSAGE "\r\n");
 		#if defined(SECOND_SEGMENT_START_INDEX)
-			SerialPort.write("SECOND_SEGMENT_START_INDEX = ");
-			SerialPort.println(SECOND_SEGMENT_START_INDEX);
+			txQueue.print("SECOND_SEGMENT_START_INDEX = " _XSTR(SECOND_SEGMENT_START_INDEX) "\r\n");
 		#endif
 
 		// Colorspace/Led type info
 		#if defined(NEOPIXEL_RGBW) || defined(NEOPIXEL_RGB)
 			#ifdef NEOPIXEL_RGBW
 				#ifdef COLD_WHITE
-					Serial.println("NeoPixelBus SK6812 cold GRBW. ");
+					txQueue.print("NeoPixelBus SK6812 cold GRBW. \r\n");
 				#else
-					Serial.println("NeoPixelBus SK6812 neutral GRBW. ");
+					txQueue.print("NeoPixelBus SK6812 neutral GRBW. \r\n");
 				#endif
-				calibrationConfig.printCalibration();
+				calibrationConfig.formatCalibration(output, sizeof(output));
+				txQueue.print(output);
 			#else
-				Serial.println("NeoPixelBus ws281x type (GRB).");
+				txQueue.print("NeoPixelBus ws281x type (GRB).\r\n");
 			#endif
 		#elif defined(SPILED_APA102)
-			Serial.println("SPI APA102 compatible type (BGR).");
+			txQueue.print("SPI APA102 compatible type (BGR).\r\n");
 		#elif defined(SPILED_WS2801)
-			Serial.println("SPI WS2801 (RBG).");
+			txQueue.print("SPI WS2801 (RBG).\r\n");
 		#endif
 
-		//Serial.flush();
-		delay(50);
+		#if defined(USE_PSRAM)
+			snprintf(output, sizeof(output), "PSRAM = %u\r\n", ESP.getFreePsram());
+			txQueue.print(output);
+		#endif
+
+		#if !defined(FAST_BOOT)
+			txQueue.flush(SerialPort);
+			delay(50);
+		#endif
 	#endif
 
 	#if defined(LED_POWER_PIN)
-		Serial.write("LED_POWER_PIN = ");
-		Serial.println(LED_POWER_PIN);
+		txQueue.print("LED_POWER_PIN = " _XSTR(LED_POWER_PIN) "\r\n");
+		#if !defined(FAST_BOOT)
+			txQueue.flush(SerialPort);
+		#endif
 		powerControl.init();
 	#endif
 
@@ -257,6 +362,8 @@ void setup()
 	{
 		// create a semaphore to synchronize threads
 		base.i2sXSemaphore = xSemaphoreCreateBinary();
+		// wake up the processing task when the LED bus is free for a waiting frame
+		renderScheduler.begin(base.i2sXSemaphore);
 
 
 		// create new task for handling received serial data on core 0
@@ -278,6 +385,8 @@ void setup()
 			&base.processSerialHandle,
 			1);
 	}
+
+	statistics.setReadyTime(micros());
 }
 
 void loop()
@@ -286,6 +395,7 @@ void loop()
 	{
 		serialTaskHandler();
 		processData();
+		txQueue.drain(SerialPort);
 	}
 }
 
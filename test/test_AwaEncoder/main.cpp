@@ -0,0 +1,224 @@
+/* test_AwaEncoder/main.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#define NO_GLOBAL_SERIAL
+#define HYPERSERIAL_TESTING
+
+#include <Arduino.h>
+#include <unity.h>
+#include "awaencoder.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+////////////////////////// AWA FRAME ENCODER TEST /////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+#define TEST_MAX_PAYLOAD (AwaEncoder::CHECKSUM_BLOCK * 3 + 21)
+uint8_t _payload[TEST_MAX_PAYLOAD];
+uint8_t _frame[TEST_MAX_PAYLOAD + 16];
+
+/**
+ * @brief Compare the block checksum with the per-byte reference
+ *
+ * @param size
+ */
+void verifyChecksum(size_t size)
+{
+	uint8_t fast[AwaEncoder::TRAILER_SIZE], reference[AwaEncoder::TRAILER_SIZE];
+
+	AwaEncoder::writeChecksum(_payload, size, fast);
+	AwaEncoder::checksumReference(_payload, size, reference);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(reference[0], fast[0], "Unexpected fletcher1");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(reference[1], fast[1], "Unexpected fletcher2");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(reference[2], fast[2], "Unexpected fletcherExt");
+}
+
+/**
+ * @brief Every payload size around the unrolled loop and the block limits, random and worst case (0xff) data
+ *
+ */
+void AwaEncoderTest_ChecksumMatchesReference()
+{
+	for(size_t i = 0; i < TEST_MAX_PAYLOAD; i++)
+	{
+		_payload[i] = random(256);
+	}
+
+	for(size_t size = 0; size < 300; size++)
+	{
+		verifyChecksum(size);
+	}
+
+	for(size_t size = AwaEncoder::CHECKSUM_BLOCK - 9; size < AwaEncoder::CHECKSUM_BLOCK + 9; size++)
+	{
+		verifyChecksum(size);
+	}
+
+	for(int i = 0; i < 50; i++)
+	{
+		verifyChecksum(random(TEST_MAX_PAYLOAD));
+	}
+
+	memset(_payload, 0xff, sizeof(_payload));
+	verifyChecksum(TEST_MAX_PAYLOAD);
+}
+
+/**
+ * @brief fletcherExt equal to 0x41 ('A') is sent as 0xaa, so the trailer never looks like the next header
+ *
+ */
+void AwaEncoderTest_FletcherExtQuirk()
+{
+	uint8_t trailer[AwaEncoder::TRAILER_SIZE];
+
+	_payload[0] = 0x41;
+	AwaEncoder::writeChecksum(_payload, 1, trailer);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0xaa, trailer[2], "fletcherExt 0x41 must be sent as 0xaa");
+
+	_payload[0] = 0x40;
+	AwaEncoder::writeChecksum(_payload, 1, trailer);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0x40, trailer[2], "Unexpected fletcherExt");
+}
+
+/**
+ * @brief Header, calibration and trailer of the protocol v1/v2 frames
+ *
+ */
+void AwaEncoderTest_FrameLayout()
+{
+	const int leds = 300;
+	AwaEncoder::Calibration calibration = { 0xff, 0xa0, 0xb0, 0xc0 };
+
+	for(int i = 0; i < leds * 3; i++)
+	{
+		_payload[i] = random(256);
+	}
+
+	size_t size = AwaEncoder::encodeFrame(_frame, sizeof(_frame), _payload, leds);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(6 + leds * 3 + 3, size, "Unexpected v1 frame size");
+	TEST_ASSERT_EQUAL_INT_MESSAGE('A', _frame[0], "Unexpected header");
+	TEST_ASSERT_EQUAL_INT_MESSAGE('w', _frame[1], "Unexpected header");
+	TEST_ASSERT_EQUAL_INT_MESSAGE('a', _frame[2], "Unexpected protocol v1 type");
+	TEST_ASSERT_EQUAL_INT_MESSAGE((leds - 1) >> 8, _frame[3], "Unexpected LED count (hi)");
+	TEST_ASSERT_EQUAL_INT_MESSAGE((leds - 1) & 0xff, _frame[4], "Unexpected LED count (lo)");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(_frame[3] ^ _frame[4] ^ 0x55, _frame[5], "Unexpected header CRC");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, memcmp(_payload, &(_frame[6]), leds * 3), "Unexpected colors");
+
+	size = AwaEncoder::encodeFrame(_frame, sizeof(_frame), _payload, leds, &calibration);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(6 + leds * 3 + 4 + 3, size, "Unexpected v2 frame size");
+	TEST_ASSERT_EQUAL_INT_MESSAGE('A', _frame[2], "Unexpected protocol v2 type");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0xff, _frame[6 + leds * 3], "Unexpected calibration gain");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0xc0, _frame[6 + leds * 3 + 3], "Unexpected calibration blue");
+
+	// the checksum covers the calibration
+	uint8_t trailer[AwaEncoder::TRAILER_SIZE];
+	AwaEncoder::checksumReference(&(_frame[6]), leds * 3 + 4, trailer);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, memcmp(trailer, &(_frame[size - 3]), 3), "Unexpected v2 trailer");
+
+	// colors already in place
+	memcpy(&(_frame[AwaEncoder::HEADER_SIZE]), _payload, leds * 3);
+	size = AwaEncoder::encodeFrame(_frame, sizeof(_frame), &(_frame[AwaEncoder::HEADER_SIZE]), leds);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, memcmp(_payload, &(_frame[6]), leds * 3), "Colors in place were changed");
+	AwaEncoder::checksumReference(_payload, leds * 3, trailer);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, memcmp(trailer, &(_frame[size - 3]), 3), "Unexpected v1 trailer");
+}
+
+/**
+ * @brief Invalid LED count and too small buffer are rejected, the remap table and the commands
+ *
+ */
+void AwaEncoderTest_LimitsAndOtherFrames()
+{
+	uint16_t table[] = { 0, 0x0102, 0xfffe };
+
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, AwaEncoder::encodeFrame(_frame, sizeof(_frame), _payload, 0), "Empty frame was accepted");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, AwaEncoder::encodeFrame(_frame, AwaEncoder::getFrameSize(10, false) - 1, _payload, 10), "Buffer overflow");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(AwaEncoder::getFrameSize(10, false), AwaEncoder::encodeFrame(_frame, AwaEncoder::getFrameSize(10, false), _payload, 10), "Exact buffer was rejected");
+
+	size_t size = AwaEncoder::encodeRemapFrame(_frame, sizeof(_frame), table, 3);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(6 + 3 * 2 + 3, size, "Unexpected remap frame size");
+	TEST_ASSERT_EQUAL_INT_MESSAGE('m', _frame[2], "Unexpected remap type");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0x01, _frame[8], "Unexpected remap entry (hi)");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0x02, _frame[9], "Unexpected remap entry (lo)");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0xfe, _frame[11], "Unexpected remap entry (lo)");
+
+	for(int i = 0; i < 3 * 3; i++)
+	{
+		_payload[i] = random(256);
+	}
+
+	size = AwaEncoder::encodeSequencedFrame(_frame, sizeof(_frame), _payload, 3, 0x1234);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(AwaEncoder::getFrameSize(3, false, true), size, "Unexpected sequenced frame size");
+	TEST_ASSERT_EQUAL_INT_MESSAGE('s', _frame[2], "Unexpected sequenced type");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0x12, _frame[6], "Unexpected sequence (hi)");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0x34, _frame[7], "Unexpected sequence (lo)");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, memcmp(_payload, &(_frame[8]), 3 * 3), "Unexpected sequenced colors");
+
+	// the checksum covers the sequence number
+	uint8_t trailer[AwaEncoder::TRAILER_SIZE];
+	AwaEncoder::checksumReference(&(_frame[6]), 2 + 3 * 3, trailer);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, memcmp(trailer, &(_frame[size - 3]), 3), "Unexpected sequenced trailer");
+
+	size = AwaEncoder::encodeTimedFrame(_frame, sizeof(_frame), _payload, 3, 0x1234, 0x89abcdef);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(AwaEncoder::getFrameSize(3, false, true, true), size, "Unexpected timed frame size");
+	TEST_ASSERT_EQUAL_INT_MESSAGE('p', _frame[2], "Unexpected timed type");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0x12, _frame[6], "Unexpected timed sequence (hi)");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0x89, _frame[8], "Unexpected presentation time (msb)");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0xef, _frame[11], "Unexpected presentation time (lsb)");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, memcmp(_payload, &(_frame[12]), 3 * 3), "Unexpected timed colors");
+	AwaEncoder::checksumReference(&(_frame[6]), 6 + 3 * 3, trailer);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, memcmp(trailer, &(_frame[size - 3]), 3), "Unexpected timed trailer");
+
+	size = AwaEncoder::encodeCommand(_frame, sizeof(_frame), 0x35);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(AwaEncoder::COMMAND_SIZE, size, "Unexpected command size");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0x2a, _frame[3], "Unexpected command marker");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0xa2, _frame[4], "Unexpected command marker");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0x35, _frame[5], "Unexpected command");
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////// UNIT TEST ROUTINES //////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+void setup()
+{
+	delay(1500);
+	randomSeed(analogRead(0));
+	UNITY_BEGIN();
+	RUN_TEST(AwaEncoderTest_ChecksumMatchesReference);
+	RUN_TEST(AwaEncoderTest_FletcherExtQuirk);
+	RUN_TEST(AwaEncoderTest_FrameLayout);
+	RUN_TEST(AwaEncoderTest_LimitsAndOtherFrames);
+	UNITY_END();
+}
+
+void loop()
+{
+}
@@ -32,6 +32,7 @@
 #include <NeoPixelBus.h>
 #include <unity.h>
 #include "calibration.h"
+#include "awaencoder.h"
 
 ///////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////
@@ -65,15 +66,7 @@ class SerialTester
 						uint8_t _white_channel_red = 0, uint8_t _white_channel_green = 0,
 						uint8_t _white_channel_blue = 0)
 		{
-			_ledBuffer[0] = 'A';
-			_ledBuffer[1] = 'w';
-			_ledBuffer[2] = (_white_channel_calibration) ? 'A' : 'a';
-			_ledBuffer[4] = (TEST_LEDS_NUMBER-1) & 0xff;
-			_ledBuffer[3] = ((TEST_LEDS_NUMBER-1) >> 8) & 0xff;
-			_ledBuffer[5] = _ledBuffer[3] ^ _ledBuffer[4] ^ 0x55;
-
-			uint8_t* writer = &(_ledBuffer[6]);
-			uint8_t* hasher = writer;
+			uint8_t* writer = &(_ledBuffer[AwaEncoder::HEADER_SIZE]);
 
 			for(int i=0; i < TEST_LEDS_NUMBER; i++)
 			{
@@ -82,28 +75,10 @@ class SerialTester
 				*(writer++)=random(255);
 			}
 
+			AwaEncoder::Calibration calibration = { _white_channel_limit, _white_channel_red, _white_channel_green, _white_channel_blue };
 
-			if (_white_channel_calibration)
-			{
-				*(writer++) = _white_channel_limit;
-				*(writer++) = _white_channel_red;
-				*(writer++) = _white_channel_green;
-				*(writer++) = _white_channel_blue;
-			}
-
-			uint16_t fletcher1 = 0, fletcher2 = 0, fletcherExt = 0;
-			uint8_t position = 0;
-			while (hasher < writer)
-			{
-				fletcherExt = (fletcherExt + (*(hasher) ^ (position++))) % 255;
-				fletcher1 = (fletcher1 + *(hasher++)) % 255;
-				fletcher2 = (fletcher2 + fletcher1) % 255;
-			}
-			*(writer++) = (uint8_t)fletcher1;
-			*(writer++) = (uint8_t)fletcher2;
-			*(writer++) = (uint8_t)((fletcherExt != 0x41) ? fletcherExt : 0xaa);
-
-			frameSize = (int)(writer - _ledBuffer);
+			frameSize = (int)AwaEncoder::encodeFrame(_ledBuffer, sizeof(_ledBuffer), &(_ledBuffer[AwaEncoder::HEADER_SIZE]), TEST_LEDS_NUMBER,
+														(_white_channel_calibration) ? &calibration : nullptr);
 			sent = 0;
 		}
 
@@ -215,6 +190,20 @@ class ProtocolTester {
 			return lastCount;
 		}
 
+		uint8_t* Pixels()
+		{
+			return nullptr;
+		}
+
+		size_t PixelsSize()
+		{
+			return 0;
+		}
+
+		void Dirty()
+		{
+		}
+
 		/**
 		 * @brief Very important: verify LED color, compare it to the origin
 		 *
@@ -0,0 +1,381 @@
+/* test_RemapTable/main.cpp
+*
+*  MIT License
+*
+*  Copyright (c) 2021-2026 awawa-dev
+*
+*  https://github.com/awawa-dev/HyperSerialESP32
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is
+*  furnished to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all
+*  copies or substantial portions of the Software.
+
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*  SOFTWARE.
+ */
+
+#define NO_GLOBAL_SERIAL
+#define HYPERSERIAL_TESTING
+
+#include <Arduino.h>
+#include <NeoPixelBus.h>
+#include <unity.h>
+#include "calibration.h"
+#include "awaencoder.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+/////////////////////// AWA PROTOCOL CORRECTNESS TEST /////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+#define TEST_LEDS_NUMBER 1025
+uint8_t _ledBuffer[TEST_LEDS_NUMBER * 3 + 6 + 8];
+
+#define LED_DRIVER ProtocolTester
+#define LED_DRIVER2 ProtocolTester
+#define SECOND_SEGMENT_START_INDEX 513
+#define SECOND_SEGMENT_CLOCK_PIN   100
+#define SECOND_SEGMENT_DATA_PIN    101
+
+/**
+ * @brief Mockup Serial class to simulate the real communition
+ *
+ */
+
+class SerialTester
+{
+		int frameSize = 0;
+		int sent = 0;
+
+	public:
+
+		void createTestFrame(bool _white_channel_calibration, uint8_t _white_channel_limit = 0,
+						uint8_t _white_channel_red = 0, uint8_t _white_channel_green = 0,
+						uint8_t _white_channel_blue = 0)
+		{
+			uint8_t* writer = &(_ledBuffer[AwaEncoder::HEADER_SIZE]);
+
+			for(int i=0; i < TEST_LEDS_NUMBER; i++)
+			{
+				*(writer++)=random(255);
+				*(writer++)=random(255);
+				*(writer++)=random(255);
+			}
+
+			AwaEncoder::Calibration calibration = { _white_channel_limit, _white_channel_red, _white_channel_green, _white_channel_blue };
+
+			frameSize = (int)AwaEncoder::encodeFrame(_ledBuffer, sizeof(_ledBuffer), &(_ledBuffer[AwaEncoder::HEADER_SIZE]), TEST_LEDS_NUMBER,
+														(_white_channel_calibration) ? &calibration : nullptr);
+			sent = 0;
+		}
+
+		/**
+		 * @brief Create the remap table frame: identity for the first segment, reversed second segment
+		 *
+		 */
+		void createRemapFrame()
+		{
+			uint16_t table[TEST_LEDS_NUMBER];
+
+			for(int i=0; i < TEST_LEDS_NUMBER; i++)
+			{
+				table[i] = (i < SECOND_SEGMENT_START_INDEX) ? i : (TEST_LEDS_NUMBER - 1 - i + SECOND_SEGMENT_START_INDEX);
+			}
+
+			frameSize = (int)AwaEncoder::encodeRemapFrame(_ledBuffer, sizeof(_ledBuffer), table, TEST_LEDS_NUMBER);
+			sent = 0;
+		}
+
+
+		inline size_t write(const char * s)
+		{
+			return 0;
+		}
+
+		inline size_t print(unsigned char, int = DEC)
+		{
+			return 0;
+		}
+
+		inline size_t print(char*)
+		{
+			return 0;
+		}
+
+		int available(void)
+		{
+			if (sent < frameSize)
+			{
+				return std::min(std::max((int)(random(64)), 1), frameSize - sent);
+			}
+
+			return 0;
+		}
+
+		int toSend(void)
+		{
+			return frameSize - sent;
+		}
+
+		int getFrameSize()
+		{
+			return frameSize;
+		}
+
+		size_t read(uint8_t *buffer, size_t size)
+		{
+			int max = std::min(frameSize - sent, (int)size);
+			if (max > 0)
+			{
+				memcpy(buffer, &(_ledBuffer[sent]), max);
+				sent += max;
+				return max;
+			}
+			return 0;
+		}
+
+		void println(const String &s)
+		{
+
+		}
+} SerialPort;
+
+
+/**
+ * @brief Mockup LED driver to verify correctness of the received LEDs color values
+ * The second segment is not reversed by the firmware configuration, the remap table does it
+ *
+ */
+
+class ProtocolTester {
+	int ledCount;
+	int currentIndex;
+	int lastCount;
+	bool first;
+
+	public:
+		ProtocolTester(int _count, int _pin) : ProtocolTester(_count)
+		{
+			if (_pin == SECOND_SEGMENT_DATA_PIN)
+				first = false;
+		}
+
+		ProtocolTester(int _count)
+		{
+			first = true;
+			ledCount = _count;
+			currentIndex = 0;
+			lastCount = 0;
+		}
+
+		bool CanShow()
+		{
+			return true;
+		}
+
+		void Show(bool safe = true)
+		{
+			lastCount = currentIndex;
+			currentIndex = 0;
+		}
+
+		void Begin()
+		{
+
+		}
+
+		void Begin(int _pin1, int _pin2, int _pin3, int _pin4)
+		{
+			if (_pin1 == SECOND_SEGMENT_CLOCK_PIN)
+				first = false;
+		}
+
+		int getLastCount()
+		{
+			return lastCount;
+		}
+
+		uint8_t* Pixels()
+		{
+			return nullptr;
+		}
+
+		size_t PixelsSize()
+		{
+			return 0;
+		}
+
+		void Dirty()
+		{
+		}
+
+		/**
+		 * @brief Very important: verify LED color, compare it to the origin
+		 *
+		 * @param indexPixel
+		 * @param color
+		 */
+		#ifdef NEOPIXEL_RGBW
+			void SetPixelColor(uint16_t indexPixel, RgbwColor color)
+			{
+				if (!first)
+					TEST_ASSERT_EQUAL_INT_MESSAGE(ledCount - currentIndex - 1, indexPixel, "Unexpected LED index");
+				TEST_ASSERT_LESS_THAN_MESSAGE(TEST_LEDS_NUMBER, indexPixel, "LED index out of scope");
+				if (!first)
+					indexPixel = TEST_LEDS_NUMBER - 1 - indexPixel;
+				uint8_t *c = &(_ledBuffer[6 + indexPixel * 3]);
+				uint8_t r = *(c++);
+				uint8_t g = *(c++);
+				uint8_t b = *(c++);
+
+				uint8_t  w = min(channelCorrection.red[r],
+								min(channelCorrection.green[g],
+									channelCorrection.blue[b]));
+				r -= channelCorrection.red[w];
+				g -= channelCorrection.green[w];
+				b -= channelCorrection.blue[w];
+				w = channelCorrection.white[w];
+
+				TEST_ASSERT_EQUAL_UINT8(r, color.R);
+				TEST_ASSERT_EQUAL_UINT8(g, color.G);
+				TEST_ASSERT_EQUAL_UINT8(b, color.B);
+				TEST_ASSERT_EQUAL_UINT8(w, color.W);
+
+				currentIndex++;
+				lastCount = 0;
+			}
+		#else
+			void SetPixelColor(uint16_t indexPixel, RgbColor color)
+			{
+				if (!first)
+					TEST_ASSERT_EQUAL_INT_MESSAGE(ledCount - currentIndex - 1, indexPixel, "Unexpected LED index");
+				TEST_ASSERT_LESS_THAN_MESSAGE(TEST_LEDS_NUMBER, indexPixel, "LED index out of scope");
+				if (!first)
+					indexPixel = TEST_LEDS_NUMBER - 1 - indexPixel;
+				uint8_t *c = &(_ledBuffer[6 + indexPixel * 3]);
+				uint8_t r = *(c++);
+				uint8_t g = *(c++);
+				uint8_t b = *(c++);
+
+				TEST_ASSERT_EQUAL_UINT8(r, color.R);
+				TEST_ASSERT_EQUAL_UINT8(g, color.G);
+				TEST_ASSERT_EQUAL_UINT8(b, color.B);
+
+				currentIndex++;
+				lastCount = 0;
+			}
+		#endif
+};
+
+#include "main.h"
+
+
+
+/**
+ * @brief Upload the remap table that reverses the second segment
+ *
+ */
+void RemapTableTest_UploadTable()
+{
+	SerialPort.createRemapFrame();
+	base.queueCurrent = 0;
+	base.queueEnd = 0;
+	statistics.update(0);
+
+	while(SerialPort.toSend() > 0)
+	{
+		serialTaskHandler();
+	}
+	processData();
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, statistics.getGoodFrames(), "Remap table is not a color frame");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(TEST_LEDS_NUMBER, remapTable.getSize(), "Remap table is not received");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(0, remapTable.map(0), "Unexpected identity mapping (segment1)");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(SECOND_SEGMENT_START_INDEX - 1, remapTable.map(SECOND_SEGMENT_START_INDEX - 1), "Unexpected identity mapping (segment1)");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(TEST_LEDS_NUMBER - 1, remapTable.map(SECOND_SEGMENT_START_INDEX), "Unexpected reversed mapping (segment2)");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(SECOND_SEGMENT_START_INDEX, remapTable.map(TEST_LEDS_NUMBER - 1), "Unexpected reversed mapping (segment2)");
+}
+
+/**
+ * @brief Damaged remap table must be rejected and the current one is still in use
+ *
+ */
+void RemapTableTest_DamagedTable()
+{
+	for(int i = 0; i < 20; i++)
+	{
+		SerialPort.createRemapFrame();
+		statistics.update(0);
+
+		int index = 6 + random(TEST_LEDS_NUMBER * 2);
+		_ledBuffer[index] ^= 0x01;
+
+		while(SerialPort.toSend() > 0)
+		{
+			serialTaskHandler();
+		}
+		processData();
+		frameState.setState(AwaProtocol::HEADER_A);
+
+		TEST_ASSERT_EQUAL_INT_MESSAGE(TEST_LEDS_NUMBER, remapTable.getSize(), "Remap table was lost");
+		TEST_ASSERT_EQUAL_INT_MESSAGE(TEST_LEDS_NUMBER - 1, remapTable.map(SECOND_SEGMENT_START_INDEX), "Damaged remap table was accepted");
+	}
+}
+
+/**
+ * @brief Send 100 RGB/RGBW frames and verify it all (including proper colors rendering of the remapped segment)
+ *
+ */
+void RemapTableTest_Send100Frames()
+{
+	base.queueCurrent = 0;
+	base.queueEnd = 0;
+
+	for(int i = 0; i < 100; i++)
+	{
+		SerialPort.createTestFrame(false);
+		statistics.update(0);
+
+		while(SerialPort.toSend() > 0)
+		{
+			serialTaskHandler();
+		}
+		TEST_ASSERT_EQUAL_INT_MESSAGE(0, statistics.getGoodFrames(), "Unexpected initial stats value");
+		processData();
+		TEST_ASSERT_EQUAL_INT_MESSAGE(1, statistics.getGoodFrames(), "Frame is not received");
+		TEST_ASSERT_EQUAL_INT_MESSAGE(SECOND_SEGMENT_START_INDEX, base.getLedStrip1()->getLastCount(), "Not all LEDs were set up (segment1)");
+		TEST_ASSERT_EQUAL_INT_MESSAGE(TEST_LEDS_NUMBER - SECOND_SEGMENT_START_INDEX, base.getLedStrip2()->getLastCount(), "Not all LEDs were set up(segment2)");
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////// UNIT TEST ROUTINES //////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////
+
+void setup()
+{
+	delay(1500);
+	randomSeed(analogRead(0));
+	UNITY_BEGIN();
+	RUN_TEST(RemapTableTest_UploadTable);
+	RUN_TEST(RemapTableTest_DamagedTable);
+	RUN_TEST(RemapTableTest_Send100Frames);
+	UNITY_END();
+}
+
+void loop()
+{
+}
@@ -32,6 +32,8 @@
 #include <NeoPixelBus.h>
 #include <unity.h>
 #include "calibration.h"
+#include "awaencoder.h"
+#include "awarecord.h"
 
 ///////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////
@@ -145,6 +147,8 @@ void CommonTest_OldAndNedCalibrationAlgorithm()
 
 #define TEST_LEDS_NUMBER 801
 uint8_t _ledBuffer[TEST_LEDS_NUMBER * 3 + 6 + 8];
+// position of the first color in the frame
+int _colorsOffset = AwaEncoder::HEADER_SIZE;
 
 /**
  * @brief Mockup Serial class to simulate the real communition
@@ -162,15 +166,7 @@ class SerialTester
 						uint8_t _white_channel_red = 0, uint8_t _white_channel_green = 0,
 						uint8_t _white_channel_blue = 0)
 		{
-			_ledBuffer[0] = 'A';
-			_ledBuffer[1] = 'w';
-			_ledBuffer[2] = (_white_channel_calibration) ? 'A' : 'a';
-			_ledBuffer[4] = (TEST_LEDS_NUMBER-1) & 0xff;
-			_ledBuffer[3] = ((TEST_LEDS_NUMBER-1) >> 8) & 0xff;
-			_ledBuffer[5] = _ledBuffer[3] ^ _ledBuffer[4] ^ 0x55;
-
-			uint8_t* writer = &(_ledBuffer[6]);
-			uint8_t* hasher = writer;
+			uint8_t* writer = &(_ledBuffer[AwaEncoder::HEADER_SIZE]);
 
 			for(int i=0; i < TEST_LEDS_NUMBER; i++)
 			{
@@ -179,27 +175,31 @@ class SerialTester
 				*(writer++)=random(255);
 			}
 
-			if (_white_channel_calibration)
-			{
-				*(writer++) = _white_channel_limit;
-				*(writer++) = _white_channel_red;
-				*(writer++) = _white_channel_green;
-				*(writer++) = _white_channel_blue;
-			}
+			AwaEncoder::Calibration calibration = { _white_channel_limit, _white_channel_red, _white_channel_green, _white_channel_blue };
+
+			_colorsOffset = AwaEncoder::HEADER_SIZE;
+			frameSize = (int)AwaEncoder::encodeFrame(_ledBuffer, sizeof(_ledBuffer), &(_ledBuffer[AwaEncoder::HEADER_SIZE]), TEST_LEDS_NUMBER,
+														(_white_channel_calibration) ? &calibration : nullptr);
+			sent = 0;
+		}
+
+		/**
+		 * @brief Create the frame with the sequence number (acknowledged by the device)
+		 *
+		 * @param sequence
+		 */
+		void createSequencedFrame(uint16_t sequence)
+		{
+			uint8_t* writer = &(_ledBuffer[AwaEncoder::HEADER_SIZE + AwaEncoder::SEQUENCE_SIZE]);
 
-			uint16_t fletcher1 = 0, fletcher2 = 0, fletcherExt = 0;
-			uint8_t position = 0;
-			while (hasher < writer)
+			for(int i=0; i < TEST_LEDS_NUMBER * 3; i++)
 			{
-				fletcherExt = (fletcherExt + (*(hasher) ^ (position++))) % 255;
-				fletcher1 = (fletcher1 + *(hasher++)) % 255;
-				fletcher2 = (fletcher2 + fletcher1) % 255;
+				*(writer++)=random(255);
 			}
-			*(writer++) = (uint8_t)fletcher1;
-			*(writer++) = (uint8_t)fletcher2;
-			*(writer++) = (uint8_t)((fletcherExt != 0x41) ? fletcherExt : 0xaa);
 
-			frameSize = (int)(writer - _ledBuffer);
+			_colorsOffset = AwaEncoder::HEADER_SIZE + AwaEncoder::SEQUENCE_SIZE;
+			frameSize = (int)AwaEncoder::encodeSequencedFrame(_ledBuffer, sizeof(_ledBuffer),
+														&(_ledBuffer[AwaEncoder::HEADER_SIZE + AwaEncoder::SEQUENCE_SIZE]), TEST_LEDS_NUMBER, sequence);
 			sent = 0;
 		}
 
@@ -306,6 +306,20 @@ class ProtocolTester {
 			return lastCount;
 		}
 
+		uint8_t* Pixels()
+		{
+			return nullptr;
+		}
+
+		size_t PixelsSize()
+		{
+			return 0;
+		}
+
+		void Dirty()
+		{
+		}
+
 		/**
 		 * @brief Very important: verify LED color, compare it to the origin
 		 *
@@ -317,7 +331,7 @@ class ProtocolTester {
 			{
 				TEST_ASSERT_EQUAL_INT_MESSAGE(currentIndex, indexPixel, "Unexpected LED index");
 				TEST_ASSERT_LESS_THAN_MESSAGE(TEST_LEDS_NUMBER, indexPixel, "LED index out of scope");
-				uint8_t *c = &(_ledBuffer[6 + indexPixel * 3]);
+				uint8_t *c = &(_ledBuffer[_colorsOffset + indexPixel * 3]);
 				uint8_t r = *(c++);
 				uint8_t g = *(c++);
 				uint8_t b = *(c++);
@@ -343,7 +357,7 @@ class ProtocolTester {
 			{
 				TEST_ASSERT_EQUAL_INT_MESSAGE(currentIndex, indexPixel, "Unexpected LED index");
 				TEST_ASSERT_LESS_THAN_MESSAGE(TEST_LEDS_NUMBER, indexPixel, "LED index out of scope");
-				uint8_t *c = &(_ledBuffer[6 + indexPixel * 3]);
+				uint8_t *c = &(_ledBuffer[_colorsOffset + indexPixel * 3]);
 				uint8_t r = *(c++);
 				uint8_t g = *(c++);
 				uint8_t b = *(c++);
@@ -486,6 +500,54 @@ void SingleSegmentTest_Send200UncertainFrames()
 	}
 }
 
+/**
+ * @brief Frames with the sequence number are acknowledged (received, shown, free space), the plain frames are not
+ *
+ */
+void SingleSegmentTest_SequencedFrames()
+{
+	AwaRecordReceiver receiver(ACK_RECORD_TYPE);
+
+	base.queueCurrent = 0;
+	base.queueEnd = 0;
+	txQueue.flush(receiver);
+	receiver.count = 0;
+
+	for(int i = 0; i < 20; i++)
+	{
+		uint16_t sequence = 0xfff6 + i;
+
+		SerialPort.createSequencedFrame(sequence);
+		statistics.update(0);
+
+		while(SerialPort.toSend() > 0)
+		{
+			serialTaskHandler();
+		}
+		processData();
+		txQueue.flush(receiver);
+
+		TEST_ASSERT_EQUAL_INT_MESSAGE(1, statistics.getGoodFrames(), "Frame is not received");
+		TEST_ASSERT_EQUAL_INT_MESSAGE(TEST_LEDS_NUMBER, base.getLedStrip1()->getLastCount(), "Not all LEDs were set up");
+		TEST_ASSERT_EQUAL_INT_MESSAGE(i + 1, receiver.count, "Frame was not acknowledged");
+		TEST_ASSERT_EQUAL_INT_MESSAGE(sequence, receiver.getLast<AckRecord>().received, "Unexpected received sequence");
+		TEST_ASSERT_EQUAL_INT_MESSAGE(sequence, receiver.getLast<AckRecord>().shown, "Unexpected shown sequence");
+		TEST_ASSERT_EQUAL_INT_MESSAGE(MAX_BUFFER - 1, receiver.getLast<AckRecord>().freeSpace, "Unexpected free space");
+	}
+
+	SerialPort.createTestFrame(false);
+	statistics.update(0);
+
+	while(SerialPort.toSend() > 0)
+	{
+		serialTaskHandler();
+	}
+	processData();
+	txQueue.flush(receiver);
+	TEST_ASSERT_EQUAL_INT_MESSAGE(1, statistics.getGoodFrames(), "Frame is not received");
+	TEST_ASSERT_EQUAL_INT_MESSAGE(20, receiver.count, "Plain frame was acknowledged");
+}
+
 ///////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////// UNIT TEST ROUTINES //////////////////////////////////
@@ -502,6 +564,7 @@ void setup()
 		RUN_TEST(SingleSegmentTest_SendRgbwCalibration);
 	#endif
 	RUN_TEST(SingleSegmentTest_Send100Frames);
+	RUN_TEST(SingleSegmentTest_SequencedFrames);
 	RUN_TEST(SingleSegmentTest_Send200UncertainFrames);
 	UNITY_END();
 }